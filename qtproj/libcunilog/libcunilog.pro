@@ -109,6 +109,7 @@ HEADERS += \
     ../../src/c/string/strintuint.h \
     ../../src/c/string/strisabsolutepath.h \
     ../../src/c/string/strisdotordotdot.h \
+    ../../src/c/string/strjson.h \
     ../../src/c/string/strmembuf.h \
     ../../src/c/string/strnewline.h \
     ../../src/c/string/struri.h \
@@ -156,6 +157,7 @@ SOURCES += \
     ../../src/c/string/strintuint.c \
     ../../src/c/string/strisabsolutepath.c \
     ../../src/c/string/strisdotordotdot.c \
+    ../../src/c/string/strjson.c \
     ../../src/c/string/strmembuf.c \
     ../../src/c/string/strnewline.c \
     ../../src/c/string/struri.c \
@@ -136,6 +136,7 @@ HEADERS += \
     ../../src/c/string/strintuint.h \
     ../../src/c/string/strisabsolutepath.h \
     ../../src/c/string/strisdotordotdot.h \
+    ../../src/c/string/strjson.h \
     ../../src/c/string/strlineextract.h \
     ../../src/c/string/strlineextractstructs.h \
     ../../src/c/string/strmembuf.h \
@@ -195,6 +196,7 @@ SOURCES += \
     ../../src/c/string/strintuint.c \
     ../../src/c/string/strisabsolutepath.c \
     ../../src/c/string/strisdotordotdot.c \
+    ../../src/c/string/strjson.c \
     ../../src/c/string/strlineextract.c \
     ../../src/c/string/strlineextractstructs.c \
     ../../src/c/string/strmembuf.c \
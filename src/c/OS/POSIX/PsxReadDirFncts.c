@@ -67,6 +67,54 @@ When		Who				What
 #include <sys/types.h>
 #include <dirent.h>
 
+static uint64_t ForEachPsxDirEntryInDIR	(
+				DIR						*dir,
+				pForEachPsxDirEntry		fedEnt,
+				void					*pCustom
+										)
+{
+	uint64_t			uiEnts				= 0;			// The return value.
+	struct dirent		*dent;
+	unsigned char		tpy;
+	SONEDIRENT			pod;
+
+	pod.pCustom = pCustom;
+
+	while (NULL != (dent = readdir (dir)))
+	{
+		tpy = dent->d_type;
+		if (DT_DIR == tpy)
+		{	// Recursion is currently not supported because Cunilog doesn't
+			//	require it.
+		} else
+		if (DT_REG == tpy)
+		{	// Regular file.
+			++ uiEnts;
+			pod.dirEnt = dent;
+			if (!fedEnt (&pod))
+				break;
+		} else
+		if (DT_UNKNOWN == tpy)
+		{	// See https://man7.org/linux/man-pages/man3/readdir.3.html .
+			/*
+				Excerpt:
+				Currently, only some filesystems (among them: Btrfs, ext2,
+				ext3, and ext4) have full support for returning the file
+				type in d_type.  All applications must properly handle a
+				return of DT_UNKNOWN.
+			*/
+
+			/*
+			if (!isDotOrDotDotW (dent->d_name))
+			{
+				
+			}
+			*/
+		}
+	}
+	return uiEnts;
+}
+
 uint64_t ForEachPsxDirEntry	(
 				const char				*strFolderName,
 				pForEachPsxDirEntry		fedEnt,
@@ -76,49 +124,13 @@ uint64_t ForEachPsxDirEntry	(
 {
 	uint64_t			uiEnts				= 0;			// The return value.
 	DIR					*dir;
-	struct dirent		*dent;
-	unsigned char		tpy;
-	SONEDIRENT			pod;
 
 	UNUSED (pnSubLevels);
 
-	pod.pCustom = pCustom;
-
 	dir = opendir (strFolderName);
 	if (dir)
 	{
-		while (NULL != (dent = readdir (dir)))
-		{
-			tpy = dent->d_type;
-			if (DT_DIR == tpy)
-			{	// Recursion is currently not supported because Cunilog doesn't
-				//	require it.
-			} else
-			if (DT_REG == tpy)
-			{	// Regular file.
-				++ uiEnts;
-				pod.dirEnt = dent;
-				if (!fedEnt (&pod))
-					break;
-			} else
-			if (DT_UNKNOWN == tpy)
-			{	// See https://man7.org/linux/man-pages/man3/readdir.3.html .
-				/*
-					Excerpt:
-					Currently, only some filesystems (among them: Btrfs, ext2,
-					ext3, and ext4) have full support for returning the file
-					type in d_type.  All applications must properly handle a
-					return of DT_UNKNOWN.
-				*/
-
-				/*
-				if (!isDotOrDotDotW (dent->d_name))
-				{
-					
-				}
-				*/
-			}
-		}
+		uiEnts = ForEachPsxDirEntryInDIR (dir, fedEnt, pCustom);
 		closedir (dir);
 	} else
 	{	// Fail. See https://man7.org/linux/man-pages/man3/opendir.3.html .
@@ -137,6 +149,35 @@ uint64_t ForEachPsxDirEntry	(
 	return uiEnts;
 }
 
+uint64_t ForEachPsxDirEntryAt	(
+				int						dirfd,
+				pForEachPsxDirEntry		fedEnt,
+				void					*pCustom,
+				unsigned int			*pnSubLevels
+								)
+{
+	uint64_t			uiEnts				= 0;			// The return value.
+	DIR					*dir;
+
+	UNUSED (pnSubLevels);
+
+	// The directory stream takes ownership of the descriptor it's given, hence the
+	//	duplicate. The duplicate shares the file offset with dirfd, which is why the
+	//	stream is rewound before it is read.
+	int fd = dup (dirfd);
+	if (-1 == fd)
+		return uiEnts;
+	dir = fdopendir (fd);
+	if (dir)
+	{
+		rewinddir (dir);
+		uiEnts = ForEachPsxDirEntryInDIR (dir, fedEnt, pCustom);
+		closedir (dir);
+	} else
+		close (fd);
+	return uiEnts;
+}
+
 
 
 #endif													// Of #ifdef OS_IS_POSIX.
@@ -102,6 +102,22 @@ uint64_t ForEachPsxDirEntry	(
 							)
 ;
 
+/*
+	ForEachPsxDirEntryAt
+
+	Like ForEachPsxDirEntry () but reads the directory the open descriptor dirfd refers
+	to instead of a directory given by its name. The descriptor must have been opened for
+	reading, for instance with open (name, O_RDONLY | O_DIRECTORY). It is not closed by
+	the function and can be re-used for consecutive calls.
+*/
+uint64_t ForEachPsxDirEntryAt	(
+				int						dirfd,
+				pForEachPsxDirEntry		fedEnt,
+				void					*pCustom,
+				unsigned int			*pnSubLevels
+								)
+;
+
 #endif														// Of #ifdef PLATFORM_IS_POSIX.
 
 EXTERN_C_END
@@ -63,6 +63,8 @@ When		Who				What
 		#include "./stransi.h"
 		#include "./strfilesys.h"
 		#include "./strintuint.h"
+		#include "./strjson.h"
+		#include "./strhex.h"
 		#include "./strhexdump.h"
 		#include "./strmembuf.h"
 		#include "./strisabsolutepath.h"
@@ -95,6 +97,8 @@ When		Who				What
 		#include "./../string/stransi.h"
 		#include "./../string/strfilesys.h"
 		#include "./../string/strintuint.h"
+		#include "./../string/strjson.h"
+		#include "./../string/strhex.h"
 		#include "./../string/strhexdump.h"
 		#include "./../string/strmembuf.h"
 		#include "./../string/strisabsolutepath.h"
@@ -120,9 +124,17 @@ When		Who				What
 
 #endif
 
+#ifdef PLATFORM_IS_WINDOWS
+	#include <io.h>
+#endif
+
 #ifdef PLATFORM_IS_POSIX
 	#include <errno.h>
+	#include <fcntl.h>
+	#include <limits.h>
 	#include <unistd.h>
+	#include <sys/stat.h>
+	#include <sys/uio.h>
 #endif
 
 static CUNILOG_TARGET CUNILOG_TARGETstatic;
@@ -180,6 +192,9 @@ CUNILOG_PROCESSOR **CreateCopyCUNILOG_PROCESSORs (CUNILOG_PROCESSOR *cps [], uns
 			case cunilogProcessCustomProcessor:
 				stTot += ALIGNED_SIZE (sizeof (CUNILOG_CUSTPROCESS), CUNILOG_POINTER_ALIGNMENT);
 				break;
+			case cunilogProcessCollapseDuplicates:
+				stTot += ALIGNED_SIZE (sizeof (CUNILOG_COLLAPSE_DATA), CUNILOG_POINTER_ALIGNMENT);
+				break;
 			default:
 				break;
 		}
@@ -210,6 +225,11 @@ CUNILOG_PROCESSOR **CreateCopyCUNILOG_PROCESSORs (CUNILOG_PROCESSOR *cps [], uns
 					cpn [u]->pData = p;
 					p += ALIGNED_SIZE (sizeof (CUNILOG_CUSTPROCESS), CUNILOG_POINTER_ALIGNMENT);
 					break;
+				case cunilogProcessCollapseDuplicates:
+					memcpy (p, cps [u]->pData, sizeof (CUNILOG_COLLAPSE_DATA));
+					cpn [u]->pData = p;
+					p += ALIGNED_SIZE (sizeof (CUNILOG_COLLAPSE_DATA), CUNILOG_POINTER_ALIGNMENT);
+					break;
 				default:
 					break;
 			}
@@ -1090,6 +1110,7 @@ static inline void correctDefaultFrequency (CUNILOG_PROCESSOR *cp, CUNILOG_TARGE
 			case cunilogProcessOutputToConsole:
 			case cunilogProcessWriteToLogFile:
 			case cunilogProcessCustomProcessor:
+			case cunilogProcessCollapseDuplicates:
 				cp->freq = cunilogProcessAppliesTo_nAlways;
 				break;
 			case cunilogProcessUpdateLogFileName:
@@ -1127,6 +1148,9 @@ static inline void defaultProcessorParameters (CUNILOG_TARGET *put)
 	{
 		cp = put->cprocessors [n];
 		correctDefaultFrequency (cp, put);
+		// The caller's processor might not have been created with an initialiser that
+		//	knows about this member.
+		cp->pcb = NULL;
 		switch (cp->task)
 		{
 			case cunilogProcessRotateLogfiles:
@@ -1165,6 +1189,10 @@ static inline void defaultProcessorParameters (CUNILOG_TARGET *put)
 					cp->pData = pLF;
 				*/
 				break;
+			case cunilogProcessCollapseDuplicates:
+				// Requires a CUNILOG_COLLAPSE_DATA structure.
+				ubf_assert_non_NULL (cp->pData);
+				break;
 		}
 		++ n;
 	}
@@ -1223,6 +1251,7 @@ static bool prepareProcessors (CUNILOG_TARGET *put, CUNILOG_PROCESSOR **cp, unsi
 		put->nprocessors = np;
 	}
 	defaultProcessorParameters (put);
+	put->bPlanOutdated = true;
 	return true;
 }
 
@@ -1253,16 +1282,17 @@ static inline void createLogfilesSearchMask (CUNILOG_TARGET *put)
 		postfixMaskFromLogPostfix (put->culogPostfix),
 		lenDateTimeStampFromPostfix (put->culogPostfix)
 			);
-	memcpy	(
-			put->mbLogFileMask.buf.pch
-		+	put->lnAppName + 1
-		+	lenDateTimeStampFromPostfix (put->culogPostfix),
-		szCunilogLogFileNameExtension,
-		sizCunilogLogFileNameExtension
-			);
+	char *szExt =		put->mbLogFileMask.buf.pch
+					+	put->lnAppName + 1
+					+	lenDateTimeStampFromPostfix (put->culogPostfix);
+	memcpy (szExt, szCunilogLogFileNameExtension, lenCunilogLogFileNameExtension);
+	// The asterisk picks up ".gz" archives too. See endsLogFileNameWithLogOrArchive ().
+	memcpy (szExt + lenCunilogLogFileNameExtension, "*", 2);
 	put->lnLogFileMask	=	put->lnAppName + 1
 						+	lenDateTimeStampFromPostfix (put->culogPostfix)
-						+	lenCunilogLogFileNameExtension;
+						+	lenCunilogLogFileNameExtension
+						+	1;
+	ubf_assert (strlen (put->mbLogFileMask.buf.pcc) == put->lnLogFileMask);
 }
 
 static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
@@ -1274,17 +1304,21 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 	{
 		put->nprocessors = 0;
 		initSMEMBUF (&put->mbLogEventLine);
-		initSMEMBUF (&put->mbColEventLine);
+		initSMEMBUF (&put->mbJSONLine);
+		put->pevJSONLine = NULL;
+		initSMEMBUF (&put->mbCoutBuf);
+		put->lnCoutBuf = 0;
 		cunilogSetTargetInitialised (put);
 		return true;
 	}
 
 	ubf_assert (0 < CUNILOG_INITIAL_EVENTLINE_SIZE);
 	initSMEMBUFtoSize (&put->mbLogEventLine, CUNILOG_INITIAL_EVENTLINE_SIZE);
-
-	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-		initSMEMBUFtoSize (&put->mbColEventLine, CUNILOG_INITIAL_COLEVENTLINE_SIZE);
-	#endif
+	// Only allocated when required.
+	initSMEMBUF (&put->mbJSONLine);
+	put->pevJSONLine = NULL;
+	initSMEMBUF (&put->mbCoutBuf);
+	put->lnCoutBuf = 0;
 
 	str_remove_path_navigators (put->mbLogPath.buf.pch, &put->lnLogPath);
 
@@ -1324,7 +1358,8 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 	size_t stRequiredForLogFileMask =	put->lnAppName
 									+	lnUnderscore
 									+	lnRoomForStamp
-									+	sizCunilogLogFileNameExtension;
+									+	sizCunilogLogFileNameExtension
+									+	1;							// Asterisk.
 	// We also need an underscore in the search mask for LogPostfixes.
 	if (hasLogPostfix (put))
 		++ stRequiredForLogFileMask;
@@ -1438,6 +1473,7 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 			put->qu.last	= NULL;
 			put->qu.num		= 0;
 		}
+		memset (&put->shed, 0, sizeof (put->shed));
 	}
 #else
 	#define InitCUNILOG_TARGETqueue(x)
@@ -1565,6 +1601,15 @@ static inline void InitCUNILOG_TARGETdumpstructs (CUNILOG_TARGET *put)
 	//put->psdump = NULL;
 }
 
+static inline bool cunilogIsStdoutTerminal (void)
+{
+	#ifdef PLATFORM_IS_WINDOWS
+		return 0 != _isatty (_fileno (stdout));
+	#else
+		return 1 == isatty (STDOUT_FILENO);
+	#endif
+}
+
 static inline void initCUNILOG_TARGEToptionFlags (CUNILOG_TARGET *put, runProcessorsOnStartup rp)
 {
 	ubf_assert_non_NULL (put);
@@ -1580,6 +1625,15 @@ static inline void initCUNILOG_TARGEToptionFlags (CUNILOG_TARGET *put, runProces
 	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
 		cunilogTargetSetUseColourForCout (put);
 	#endif
+
+	// A pipe or a file gets block buffering and no colour codes.
+	if (!cunilogIsStdoutTerminal ())
+	{
+		cunilogSetCoutBuffered (put);
+		#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
+			cunilogTargetClrUseColourForCout (put);
+		#endif
+	}
 }
 
 static inline void initFilesListInCUNILOG_TARGET (CUNILOG_TARGET *put)
@@ -1588,19 +1642,332 @@ static inline void initFilesListInCUNILOG_TARGET (CUNILOG_TARGET *put)
 
 	vec_init (&put->fls);
 	InitSBULKMEM (&put->sbm, CUNILOG_STD_BULK_ALLOC_SIZE);
+	put->uiLogFoldMtime			= 0;
+	put->uiArchivedDotNumber	= 0;
 
 	// Note that we do not allocate any bulk memory here yet. If for instance the caller
 	//	hasn't provided a rotation processor we may not even need one.
 }
 
-static inline void initPrevTimestamp (CUNILOG_TARGET *put)
+/*
+	The files list is read from disk again when it is required next.
+*/
+static inline void cunilogResetFilesList (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	vec_clear (&put->fls);
+	EmptySBULKMEM (&put->sbm);
+	cunilogTargetClrFLSisSorted (put);
+	put->uiArchivedDotNumber = 0;
+}
+
+#ifdef PLATFORM_IS_POSIX
+	/*
+		Returns the descriptor of the logging folder, or -1 if it can't be opened. The
+		folder is opened the first time it is needed, since it might not exist yet when
+		the target is initialised. The descriptor stays open for the lifetime of the
+		target. The kernel therefore doesn't need to resolve the folder's path for every
+		operation on a logfile, and the operations still work when the path of the folder
+		changes.
+	*/
+	static int cunilogLogFoldFD (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (-1 == put->fdLogFold && put->lnLogFold)
+		{
+			put->fdLogFold = open	(
+								put->mbLogFold.buf.pcc,
+								O_RDONLY | O_DIRECTORY | O_CLOEXEC
+									);
+		}
+		return put->fdLogFold;
+	}
+
+	static inline void cunilogCloseLogFoldFD (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (-1 != put->fdLogFold)
+		{
+			close (put->fdLogFold);
+			put->fdLogFold = -1;
+		}
+	}
+
+	/*
+		The following functions take full path names, which all start with the logging
+		folder, and work relative to the folder's descriptor. If the folder can't be
+		opened, the full path names are used.
+	*/
+	static int cunilogOpenInLogFold (CUNILOG_TARGET *put, const char *szFull, int flags)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert_non_NULL	(szFull);
+		ubf_assert			(!memcmp (szFull, put->mbLogFold.buf.pcc, put->lnLogFold));
+
+		int fdFold = cunilogLogFoldFD (put);
+		if (-1 == fdFold)
+			return open (szFull, flags, CUNILOG_DEFAULT_OPEN_PERMS);
+		int fd = openat (fdFold, szFull + put->lnLogPath, flags, CUNILOG_DEFAULT_OPEN_PERMS);
+		if (-1 == fd && ENOENT == errno)
+		{	// The folder might have been deleted and created again.
+			cunilogCloseLogFoldFD (put);
+			fdFold = cunilogLogFoldFD (put);
+			if (-1 == fdFold)
+				return open (szFull, flags, CUNILOG_DEFAULT_OPEN_PERMS);
+			fd = openat (fdFold, szFull + put->lnLogPath, flags, CUNILOG_DEFAULT_OPEN_PERMS);
+		}
+		return fd;
+	}
+
+	static int cunilogRenameInLogFold (CUNILOG_TARGET *put, const char *szOld, const char *szNew)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert_non_NULL	(szOld);
+		ubf_assert_non_NULL	(szNew);
+
+		int fdFold = cunilogLogFoldFD (put);
+		if (-1 == fdFold)
+			return rename (szOld, szNew);
+		return renameat (fdFold, szOld + put->lnLogPath, fdFold, szNew + put->lnLogPath);
+	}
+
+	static int cunilogUnlinkInLogFold (CUNILOG_TARGET *put, const char *szFull)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert_non_NULL	(szFull);
+
+		int fdFold = cunilogLogFoldFD (put);
+		if (-1 == fdFold)
+			return unlink (szFull);
+		return unlinkat (fdFold, szFull + put->lnLogPath, 0);
+	}
+#endif
+
+/*
+	Returns the modification time of the logging folder, or 0 if it can't be obtained.
+	The value is only compared against a previous value and has no other meaning.
+*/
+static uint64_t cunilogLogFolderMtime (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	uint64_t	uiRet	= 0;
+
+	#if defined (PLATFORM_IS_WINDOWS)
+		HANDLE h = CreateFileU8	(
+						put->mbLogPath.buf.pcc, FILE_READ_ATTRIBUTES,
+						FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+						NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL
+								);
+		if (INVALID_HANDLE_VALUE != h)
+		{
+			FILETIME ft;
+			if (GetFileTime (h, NULL, NULL, &ft))
+				uiRet = ((uint64_t) ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+			CloseHandle (h);
+		}
+	#elif defined (PLATFORM_IS_POSIX)
+		struct stat	st;
+		int			fdFold	= cunilogLogFoldFD (put);
+		int			iStat	=	-1 == fdFold
+							?	stat (put->mbLogFold.buf.pcc, &st)
+							:	fstat (fdFold, &st);
+		if (0 == iStat)
+		{
+			#ifdef OS_IS_MACOS
+				uiRet = (uint64_t) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+			#else
+				uiRet = (uint64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+			#endif
+		}
+	#endif
+	return uiRet;
+}
+
+/*
+	To be called after the target has changed the logging folder itself and updated
+	the files list accordingly.
+*/
+static inline void cunilogFilesListInSync (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (put->fls.length)
+		put->uiLogFoldMtime = cunilogLogFolderMtime (put);
+}
+
+static inline void initPostfixPeriod (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
-	memset (put->cPrevDateTimeStamp, 0, LEN_ISO8601DATEHOURANDMINUTE);
+	put->uiPostfixPeriodStart	= 0;
+	put->uiPostfixPeriodEnd		= 0;
+	put->uiOpenPeriodEnd		= 0;
+}
+
+/*
+	Returns the UBF_TIMESTAMP of the first moment of the period of the postfix that
+	contains stamp, i.e. stamp with the bits below the postfix's unit cleared. For an
+	ISO 8601 week, this is the Monday of the week.
+*/
+static uint64_t cunilogPostfixPeriodStart (UBF_TIMESTAMP stamp, enum cunilogpostfix postfix)
+{
+	switch (postfix)
+	{
+		case cunilogPostfixMinute:
+		case cunilogPostfixMinuteT:
+			return stamp & UBF_TIMESTAMP_KEEP_FROM_MINUTE_BITS;
+		case cunilogPostfixHour:
+		case cunilogPostfixHourT:
+			return stamp & UBF_TIMESTAMP_KEEP_FROM_HOUR_BITS;
+		case cunilogPostfixDay:
+			return stamp & UBF_TIMESTAMP_KEEP_FROM_DAY_BITS;
+		case cunilogPostfixWeek:
+		{	// The Monday of the week, which might be in the previous month.
+			uint32_t	y	= UBF_TIMESTAMP_YEAR	(stamp);
+			uint8_t		m	= UBF_TIMESTAMP_MONTH	(stamp);
+			uint8_t		d	= UBF_TIMESTAMP_DAY		(stamp);
+			uint8_t		dow	= DayOfWeekFromDays (DaysFromCivil (y, m, d));
+
+			if (d > dow)
+				d -= dow;
+			else
+			{
+				if (1 == m)
+				{
+					if (2000 == y)
+						return 0;							// No earlier UBF_TIMESTAMP.
+					m = 12;
+					-- y;
+				} else
+					-- m;
+				d = d + DaysInMonth (y, m) - dow;
+			}
+			return	SET_UBF_TIMESTAMP_YEAR_BITS		(y)
+				|	SET_UBF_TIMESTAMP_MONTH_BITS	(m)
+				|	SET_UBF_TIMESTAMP_DAY_BITS		(d);
+		}
+		case cunilogPostfixMonth:
+			return stamp & UBF_TIMESTAMP_KEEP_FROM_MONTH_BITS;
+		case cunilogPostfixYear:
+			return stamp & UBF_TIMESTAMP_KEEP_FROM_YEAR_BITS;
+		default:
+			ubf_assert_msg (false, "Only postfixes with timestamps that are part of the name");
+			return 0;
+	}
+}
+
+/*
+	Returns the UBF_TIMESTAMP of the first moment after the period of the postfix that
+	contains stamp, i.e. the next change of the minute, hour, day, ISO 8601 week, month,
+	or year. Only the bits from minute upwards are set.
+
+	Adding one unit to the masked stamp can overflow the unit's bits into the next higher
+	unit, for instance minute 60 or day 32. The result is then not a valid date but still
+	greater than any UBF_TIMESTAMP within the period and not greater than the first one of
+	the next period, which is all that is required for a comparison.
+*/
+static uint64_t cunilogPostfixPeriodEnd (UBF_TIMESTAMP stamp, enum cunilogpostfix postfix)
+{
+	switch (postfix)
+	{
+		case cunilogPostfixMinute:
+		case cunilogPostfixMinuteT:
+			return	(stamp & UBF_TIMESTAMP_KEEP_FROM_MINUTE_BITS)
+				+	SET_UBF_TIMESTAMP_MINUTE_BITS (1);
+		case cunilogPostfixHour:
+		case cunilogPostfixHourT:
+			return	(stamp & UBF_TIMESTAMP_KEEP_FROM_HOUR_BITS)
+				+	SET_UBF_TIMESTAMP_HOUR_BITS (1);
+		case cunilogPostfixDay:
+			return	(stamp & UBF_TIMESTAMP_KEEP_FROM_DAY_BITS)
+				+	SET_UBF_TIMESTAMP_DAY_BITS (1);
+		case cunilogPostfixWeek:
+		{	// The next Monday. Days don't carry correctly into months.
+			uint32_t	y	= UBF_TIMESTAMP_YEAR	(stamp);
+			uint8_t		m	= UBF_TIMESTAMP_MONTH	(stamp);
+			uint8_t		d	= UBF_TIMESTAMP_DAY		(stamp);
+			uint8_t		dim	= DaysInMonth (y, m);
+
+			d += 7 - DayOfWeekFromDays (DaysFromCivil (y, m, d));
+			if (d > dim)
+			{
+				d -= dim;
+				if (12 == m ++)
+				{
+					m = 1;
+					++ y;
+				}
+			}
+			return	SET_UBF_TIMESTAMP_YEAR_BITS		(y)
+				|	SET_UBF_TIMESTAMP_MONTH_BITS	(m)
+				|	SET_UBF_TIMESTAMP_DAY_BITS		(d);
+		}
+		case cunilogPostfixMonth:
+			return	(stamp & UBF_TIMESTAMP_KEEP_FROM_MONTH_BITS)
+				+	SET_UBF_TIMESTAMP_MONTH_BITS (1);
+		case cunilogPostfixYear:
+			return	(stamp & UBF_TIMESTAMP_KEEP_FROM_YEAR_BITS)
+				+	SET_UBF_TIMESTAMP_YEAR_BITS (2000 + 1);			// One year.
+		default:
+			ubf_assert_msg (false, "Only postfixes with timestamps that are part of the name");
+			return UINT64_MAX;
+	}
+}
+
+/*
+	Returns a consecutive number for the period of the postfix that contains stamp. The
+	number of the previous period is one less. Only used to find out how far a stamp
+	lies before the current period, hence stamp must be a valid date, or, for months and
+	years, contain valid bits down to the unit of the postfix.
+*/
+static int64_t cunilogPostfixPeriodIndex (UBF_TIMESTAMP stamp, enum cunilogpostfix postfix)
+{
+	int64_t		y	= UBF_TIMESTAMP_YEAR	(stamp);
+	int64_t		m	= UBF_TIMESTAMP_MONTH	(stamp);
+
+	if (cunilogPostfixYear == postfix)
+		return y;
+	if (cunilogPostfixMonth == postfix)
+		return y * 12 + m;
+
+	int64_t		d	= DaysFromCivil ((uint32_t) y, (uint8_t) m, UBF_TIMESTAMP_DAY (stamp));
+	int64_t		h	= UBF_TIMESTAMP_HOUR	(stamp);
+
+	switch (postfix)
+	{
+		case cunilogPostfixMinute:
+		case cunilogPostfixMinuteT:
+			return (d * 24 + h) * 60 + UBF_TIMESTAMP_MINUTE (stamp);
+		case cunilogPostfixHour:
+		case cunilogPostfixHourT:
+			return d * 24 + h;
+		case cunilogPostfixDay:
+			return d;
+		case cunilogPostfixWeek:
+			return (d - DayOfWeekFromDays (d)) / 7;
+		default:
+			ubf_assert_msg (false, "Only postfixes with timestamps that are part of the name");
+			return 0;
+	}
 }
 
-static inline void savePrevTimestamp (CUNILOG_EVENT *pev)
+/*
+	Regenerates the timestamp in the logfile name, but only when the event's stamp is
+	outside the period of the current one. Otherwise this is two integer comparisons.
+
+	Events are not necessarily queued in the order of their stamps. When two threads
+	race to enqueue at a period boundary, the event with the earlier stamp can arrive
+	after the one that started the new period. Stamps of the previous period are
+	therefore written to the current logfile. Only a stamp before the start of the
+	previous period is treated as the clock having been set back. In this case the name
+	is regenerated from the earlier stamp and uiOpenPeriodEnd is reset for
+	requiresNewLogFile () to reopen the logfile.
+*/
+static inline void updatePostfixPeriod (CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (pev);
 	
@@ -1609,26 +1976,40 @@ static inline void savePrevTimestamp (CUNILOG_EVENT *pev)
 
 	ubf_assert (cunilogPostfixYear >= put->culogPostfix);
 
+	if (pev->stamp < put->uiPostfixPeriodEnd)
+	{
+		if (pev->stamp >= put->uiPostfixPeriodStart)
+			return;
+		// Out of order by not more than one period.
+		if	(
+					cunilogPostfixPeriodIndex (pev->stamp, put->culogPostfix) + 1
+				>=	cunilogPostfixPeriodIndex (put->uiPostfixPeriodStart, put->culogPostfix)
+			)
+			return;
+		// The clock has been set back.
+		put->uiOpenPeriodEnd = 0;
+	}
+
 	size_t lenPostfixStamp;
 	lenPostfixStamp = lenDateTimeStampFromPostfix (put->culogPostfix);
 	ubf_assert (0 < lenPostfixStamp);
 	ubf_assert (LEN_ISO8601DATEHOURANDMINUTE >= lenPostfixStamp);
 
-	memcpy (put->cPrevDateTimeStamp, put->szDateTimeStamp, lenPostfixStamp);
 	obtainDateAndTimeStamp (put->szDateTimeStamp, pev->stamp, put->culogPostfix);
 	put->szDateTimeStamp [lenPostfixStamp] = '.';
+	put->uiPostfixPeriodStart	= cunilogPostfixPeriodStart	(pev->stamp, put->culogPostfix);
+	put->uiPostfixPeriodEnd		= cunilogPostfixPeriodEnd	(pev->stamp, put->culogPostfix);
 }
 
+/*
+	The logfile name has moved on since the current logfile has been opened. When the
+	clock has been set back, updatePostfixPeriod () resets uiOpenPeriodEnd to 0.
+*/
 static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
-
-	int r = memcmp	(
-				put->szDateTimeStamp, put->cPrevDateTimeStamp,
-				lenDateTimeStampFromPostfix (put->culogPostfix)
-					);
-	return r > 0;
+	return put->uiPostfixPeriodEnd > put->uiOpenPeriodEnd;
 }
 
 #ifdef PLATFORM_IS_POSIX
@@ -1655,14 +2036,27 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 			memcpy (put->mbLogFold.buf.pch, put->mbLogPath.buf.pch, lenLogp);
 			put->mbLogFold.buf.pch [lenLogp] = '\0';
 			put->lnLogFold = lenLogp;
+			put->fdLogFold = -1;
 			return;
 		}
 		// We should never get here.
 		ubf_assert (false);
 		put->lnLogFold = 0;
+		put->fdLogFold = -1;
+	}
+
+	static void DoneCUNILOG_TARGETmbLogFold (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		cunilogCloseLogFoldFD (put);
+		if (isUsableSMEMBUF (&put->mbLogFold))
+			freeSMEMBUF (&put->mbLogFold);
+		put->lnLogFold = 0;
 	}
 #else
 	#define InitCUNILOG_TARGETmbLogFold(x)
+	#define DoneCUNILOG_TARGETmbLogFold(x)
 #endif
 
 static inline void cunilogInitCUNILOG_LOGFILE (CUNILOG_TARGET *put)
@@ -1674,6 +2068,7 @@ static inline void cunilogInitCUNILOG_LOGFILE (CUNILOG_TARGET *put)
 	#else
 		put->logfile.fd			= -1;
 	#endif
+	put->uiLogfileSize			= 0;
 }
 
 static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
@@ -1681,6 +2076,9 @@ static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
 	ubf_assert_non_NULL	(put);
 	ubf_assert			(isInitialisedSMEMBUF (&put->mbLogfileName));
 
+	// See requiresNewLogFile ().
+	put->uiOpenPeriodEnd = put->uiPostfixPeriodEnd;
+
 	#ifdef PLATFORM_IS_WINDOWS
 		put->logfile.hLogFile = CreateFileU8	(
 						put->mbLogfileName.buf.pcc,
@@ -1690,11 +2088,27 @@ static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
 						FILE_FLAG_SEQUENTIAL_SCAN,
 						NULL
 									);
-		return INVALID_HANDLE_VALUE != put->logfile.hLogFile;
+		if (INVALID_HANDLE_VALUE == put->logfile.hLogFile)
+			return false;
+		// Its size is tracked from here on. See cunilogWriteDataToLogFile ().
+		LARGE_INTEGER	li;
+		put->uiLogfileSize	= GetFileSizeEx (put->logfile.hLogFile, &li)
+							? (uint64_t) li.QuadPart
+							: 0;
+		return true;
 	#else
 		// We always (and automatically) append.
-		put->logfile.fd = open (put->mbLogfileName.buf.pcc, CUNILOG_DEFAULT_OPEN_MODE);
-		return -1 != put->logfile.fd;
+		put->logfile.fd = cunilogOpenInLogFold	(
+							put, put->mbLogfileName.buf.pcc, CUNILOG_DEFAULT_OPEN_MODE
+												);
+		if (-1 == put->logfile.fd)
+			return false;
+		// Its size is tracked from here on. See cunilogWriteDataToLogFile ().
+		struct stat	st;
+		put->uiLogfileSize	= 0 == fstat (put->logfile.fd, &st)
+							? (uint64_t) st.st_size
+							: 0;
+		return true;
 	#endif
 }
 
@@ -1824,7 +2238,15 @@ static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *pu
 	#endif
 	put->dumpWidth							= enDataDumpWidth16;
 	put->severityPrefix						= cunilogEvtSeverityFormatDefault;
-	initPrevTimestamp						(put);
+	put->psmpl								= NULL;
+	put->pcas								= NULL;
+	put->pplan								= NULL;
+	put->nplan								= 0;
+	put->bPlanOutdated						= true;
+	put->prlBuckets							= NULL;
+	put->uiWeekKeyDay						= 0;
+	put->uiWeekKey							= 0;
+	initPostfixPeriod						(put);
 	InitCUNILOG_TARGETmbLogFold				(put);
 	InitCUNILOG_TARGETdumpstructs			(put);
 	InitCUNILOG_LOCKER						(put);
@@ -2444,6 +2866,59 @@ void ConfigCUNILOG_TARGETprocessorList	(
 	prepareProcessors (put, cuProcessorList, nProcessors);
 }
 
+void ConfigCUNILOG_PROCESSORmaxTotalSize	(
+		CUNILOG_PROCESSOR	**cuProcessorList,					// One or more processors.
+		unsigned int		nProcessors,						// Number of processors.
+		uint64_t			uiMaxTotalSize
+											)
+{
+	CUNILOG_ROTATION_DATA	*rd;
+	unsigned int			n;
+
+	// All rotators that move logfiles to the recycle bin or delete them.
+	n = 0;
+	while	(
+				NULL != (rd = GetCUNILOG_ROTATION_DATAfromProcessor	(
+									cuProcessorList, nProcessors,
+									cunilogrotationtask_MoveToTrashLogfiles, n ++
+																	))
+			)
+		rd->uiMaxTotalSize = uiMaxTotalSize;
+	n = 0;
+	while	(
+				NULL != (rd = GetCUNILOG_ROTATION_DATAfromProcessor	(
+									cuProcessorList, nProcessors,
+									cunilogrotationtask_DeleteLogfiles, n ++
+																	))
+			)
+		rd->uiMaxTotalSize = uiMaxTotalSize;
+}
+
+void ConfigCUNILOG_PROCESSORseverityMask (CUNILOG_PROCESSOR *cup, evtsevmask_t sevmask)
+{
+	ubf_assert_non_NULL	(cup);
+
+	cup->sevSkipMask = ~ sevmask;
+}
+
+void ConfigCUNILOG_PROCESSORdisableEventSeverity (CUNILOG_PROCESSOR *cup, cueventseverity sev)
+{
+	ubf_assert_non_NULL	(cup);
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+
+	cup->sevSkipMask |= (evtsevmask_t) 1 << sev;
+}
+
+void ConfigCUNILOG_PROCESSORenableEventSeverity (CUNILOG_PROCESSOR *cup, cueventseverity sev)
+{
+	ubf_assert_non_NULL	(cup);
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+
+	cup->sevSkipMask &= ~ ((evtsevmask_t) 1 << sev);
+}
+
 void ConfigCUNILOG_PROCESSORnLogFiles	(
 		CUNILOG_PROCESSOR	**cuProcessorList,					// One or more processors.
 		unsigned int		nProcessors,						// Number of processors.
@@ -2488,8 +2963,9 @@ void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilo
 	{
 		if (task == put->cprocessors [n]->task)
 			optCunProcSetOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
-		-- n;
+		++ n;
 	}
+	put->bPlanOutdated = true;
 }
 
 /*
@@ -2506,8 +2982,16 @@ void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilog
 	{
 		if (task == put->cprocessors [n]->task)
 			optCunProcClrOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
-		-- n;
+		++ n;
 	}
+	put->bPlanOutdated = true;
+}
+
+void ConfigCUNILOG_TARGETprocessorsChanged (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL	(put);
+
+	put->bPlanOutdated = true;
 }
 
 /*
@@ -2534,46 +3018,307 @@ void ConfigCUNILOG_TARGETenableCoutProcessor (CUNILOG_TARGET *put)
 	ConfigCUNILOG_TARGETenableTaskProcessors (put, cunilogProcessOutputToConsole);
 }
 
-static bool isSeverityEnabledCUNILOG_TARGET (cueventseverity sev, CUNILOG_TARGET *put)
+/*
+	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
+	please don't forget to change it there too.
+*/
+void ConfigCUNILOG_TARGETrescanLogfiles (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL	(put);
-	ubf_assert			(0 <= sev);
-	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
 
-	evtsevmask_t	severityLevelMask	= readSeverityMaskCUNILOG_TARGET (put);
-	evtsevmask_t	currSeverityLevel	= 1 << sev;
-	bool			bRet				= severityLevelMask & currSeverityLevel;
-	return bRet;
+	cunilogResetFilesList (put);
 }
 
-void ConfigCUNILOG_TARGETeventSeverityMask (CUNILOG_TARGET *put, evtsevmask_t newsevmask)
-{
-	ubf_assert_non_NULL	(put);
-
-	writeSeverityMaskCUNILOG_TARGET (put, newsevmask);
-}
+static bool cunilogFlushCoutBuffer (CUNILOG_TARGET *put);
+static void cunilogFlushCustBatches (CUNILOG_TARGET *put);
+static void cunilogRateLimitReportPending (CUNILOG_TARGET *put);
+static void cunilogRateLimitUnregisterAll (CUNILOG_TARGET *put);
+static void cunilogDoneCustBatch (CUNILOG_PROCESSOR *cup);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void cunilogDoneCoutAsync (CUNILOG_TARGET *put);
+#else
+	#define cunilogDoneCoutAsync(x)
+#endif
 
-void ConfigCUNILOG_TARGETdisableEventSeverity (CUNILOG_TARGET *put, cueventseverity sev)
+void ConfigCUNILOG_TARGETcoutBuffered (CUNILOG_TARGET *put, bool bBuffered)
 {
 	ubf_assert_non_NULL	(put);
-	ubf_assert			(0 <= sev);
-	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
 
-	disableSeverityCUNILOG_TARGET (put, sev);
+	if (bBuffered)
+		cunilogSetCoutBuffered (put);
+	else
+	{
+		cunilogFlushCoutBuffer (put);
+		cunilogClrCoutBuffered (put);
+	}
 }
 
-void ConfigCUNILOG_TARGETenableEventSeverity (CUNILOG_TARGET *put, cueventseverity sev)
+void ConfigCUNILOG_TARGETdotNumberMonotonic (CUNILOG_TARGET *put, bool bMonotonic)
 {
 	ubf_assert_non_NULL	(put);
-	ubf_assert			(0 <= sev);
-	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
 
-	enableSeverityCUNILOG_TARGET (put, sev);
+	if (bMonotonic)
+		cunilogSetDotNumberMonotonic (put);
+	else
+		cunilogClrDotNumberMonotonic (put);
+
+	// The sort order of the files list differs between the two modes.
+	cunilogResetFilesList (put);
 }
 
-void ConfigCUNILOG_TARGETdisableEventSeverities	(
-		CUNILOG_TARGET			*put,
-		unsigned int			n,
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void incrementShedCountCUNILOG_TARGET (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+
+		#if defined (_MSC_VER)
+			InterlockedIncrement64 ((volatile LONG64 *) &put->shed.nShed);
+		#elif defined(__clang__) || defined(__GNUC__)
+			__atomic_fetch_add (&put->shed.nShed, 1, __ATOMIC_RELAXED);
+		#else
+			#error Not supported
+		#endif
+	}
+
+	static inline uint64_t resetShedCountCUNILOG_TARGET (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+
+		#if defined (_MSC_VER)
+			return (uint64_t) InterlockedExchange64 ((volatile LONG64 *) &put->shed.nShed, 0);
+		#elif defined(__clang__) || defined(__GNUC__)
+			return __atomic_exchange_n (&put->shed.nShed, 0, __ATOMIC_RELAXED);
+		#else
+			#error Not supported
+		#endif
+	}
+
+	/*
+		Returns true if the severity sev is currently being discarded because the separate
+		logging thread has fallen behind. The mask is read without the lock. A stale value
+		only means that a few events more or less are shed.
+	*/
+	static inline bool isSeverityShedCUNILOG_TARGET (cueventseverity sev, CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+
+		if (put->shed.active & ((evtsevmask_t) 1 << sev))
+		{
+			incrementShedCountCUNILOG_TARGET (put);
+			return true;
+		}
+		return false;
+	}
+
+	/*
+		Called with the lock held after an event has been enqueued. Activates all stages
+		whose queue depth has been reached.
+	*/
+	static inline void raiseSheddingCUNILOG_TARGET (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert			(CUNILOG_MAX_SHED_STAGES >= put->shed.nStages);
+
+		evtsevmask_t	active	= put->shed.active;
+		unsigned int	ui;
+		for (ui = 0; ui < put->shed.nStages; ++ ui)
+		{
+			if (put->qu.num >= put->shed.stages [ui].nDepth)
+				active |= put->shed.stages [ui].mask;
+		}
+		put->shed.active = active;
+	}
+
+	/*
+		Called by the separate logging thread after it has processed nDequeued events.
+		Ends shedding if the logging thread has caught up, and logs what has been shed.
+	*/
+	static void endSheddingCUNILOG_TARGET (CUNILOG_TARGET *put, size_t nDequeued)
+	{
+		ubf_assert_non_NULL	(put);
+
+		if (0 == put->shed.active || nDequeued > put->shed.nLowWater)
+			return;
+
+		EnterCUNILOG_LOCKER (put);
+		put->shed.active = 0;
+		LeaveCUNILOG_LOCKER (put);
+
+		uint64_t nShed = resetShedCountCUNILOG_TARGET (put);
+		if (nShed)
+		{
+			logTextU8sfmtsev	(
+				put, cunilogEvtSeverityWarning,
+				"Load shedding ended. %" PRIu64 " event(s) discarded while the logging thread "
+				"was behind.",
+				nShed
+								);
+		}
+	}
+#else
+	#define isSeverityShedCUNILOG_TARGET(sev, put)	(false)
+#endif
+
+static bool isSeverityEnabledCUNILOG_TARGET (cueventseverity sev, CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+
+	evtsevmask_t	severityLevelMask	= readSeverityMaskCUNILOG_TARGET (put);
+	evtsevmask_t	currSeverityLevel	= 1 << sev;
+	bool			bRet				= severityLevelMask & currSeverityLevel;
+	return bRet && !isSeverityShedCUNILOG_TARGET (sev, put);
+}
+
+/*
+	Returns true if an event with severity sev is kept by the sampling rate of the
+	target. This needs to be called exactly once per event, just before the event is
+	created, since it counts the events of the severity.
+*/
+static inline bool isEventSampledCUNILOG_TARGET (cueventseverity sev, CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(CUNILOG_SAMPLING_SLOTS > (unsigned) sev);
+
+	CUNILOG_SAMPLING *psmpl = put->psmpl;
+	if (NULL == psmpl)
+		return true;
+	uint32_t uiOneIn = psmpl->auiOneIn [sev];
+	if (uiOneIn < 2)
+		return true;
+
+	uint32_t uiCount;
+	#if defined (_MSC_VER)
+		uiCount = (uint32_t) InterlockedIncrement ((volatile LONG *) &psmpl->auiCount [sev]) - 1;
+	#elif defined(__clang__) || defined(__GNUC__)
+		uiCount = __atomic_fetch_add (&psmpl->auiCount [sev], 1, __ATOMIC_RELAXED);
+	#else
+		#error Not supported
+	#endif
+	return 0 == uiCount % uiOneIn;
+}
+
+/*
+	FNV-1a hash of a sampling key.
+*/
+static inline uint32_t hashSamplingKey (const char *ccKey, size_t lenKey)
+{
+	ubf_assert_non_NULL (ccKey);
+
+	uint32_t h = 2166136261u;
+	while (lenKey --)
+	{
+		h ^= (unsigned char) *ccKey ++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/*
+	Returns true if an event with severity sev and the sampling key ccKey is kept by the
+	sampling rate of the target. All events with the same key are kept or discarded
+	together.
+*/
+static inline bool isKeySampledCUNILOG_TARGET	(
+					cueventseverity				sev,
+					CUNILOG_TARGET				*put,
+					const char					*ccKey,
+					size_t						lenKey
+												)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(CUNILOG_SAMPLING_SLOTS > (unsigned) sev);
+
+	CUNILOG_SAMPLING *psmpl = put->psmpl;
+	if (NULL == psmpl)
+		return true;
+	uint32_t uiOneIn = psmpl->auiOneIn [sev];
+	if (uiOneIn < 2)
+		return true;
+	lenKey = USE_STRLEN == lenKey ? strlen (ccKey) : lenKey;
+	return 0 == hashSamplingKey (ccKey, lenKey) % uiOneIn;
+}
+
+bool ConfigCUNILOG_TARGETsampling (CUNILOG_TARGET *put, cueventseverity sev, uint32_t uiOneIn)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+
+	if (NULL == put->psmpl)
+	{
+		if (uiOneIn < 2)
+			return true;
+		CUNILOG_SAMPLING *psmpl = ubf_malloc (sizeof (CUNILOG_SAMPLING));
+		if (NULL == psmpl)
+			return false;
+		memset (psmpl, 0, sizeof (CUNILOG_SAMPLING));
+		psmpl->auiOneIn [sev] = uiOneIn;
+		put->psmpl = psmpl;
+		return true;
+	}
+	put->psmpl->auiOneIn [sev] = uiOneIn;
+	return true;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETloadShedding	(
+			CUNILOG_TARGET				*put,
+			size_t						nLowWater,
+			unsigned int				nStages,
+			const CUNILOG_SHED_STAGE	*stages
+											)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert			(CUNILOG_MAX_SHED_STAGES >= nStages);
+		ubf_assert			(0 == nStages || NULL != stages);
+
+		if	(
+					CUNILOG_MAX_SHED_STAGES < nStages
+				||	(nStages && !requiresCUNILOG_TARGETseparateLoggingThread (put))
+			)
+			return false;
+
+		EnterCUNILOG_LOCKER (put);
+		if (nStages)
+			memcpy (put->shed.stages, stages, nStages * sizeof (CUNILOG_SHED_STAGE));
+		put->shed.nStages	= nStages;
+		put->shed.nLowWater	= nLowWater;
+		put->shed.active	= 0;
+		LeaveCUNILOG_LOCKER (put);
+		return true;
+	}
+#endif
+
+void ConfigCUNILOG_TARGETeventSeverityMask (CUNILOG_TARGET *put, evtsevmask_t newsevmask)
+{
+	ubf_assert_non_NULL	(put);
+
+	writeSeverityMaskCUNILOG_TARGET (put, newsevmask);
+}
+
+void ConfigCUNILOG_TARGETdisableEventSeverity (CUNILOG_TARGET *put, cueventseverity sev)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+
+	disableSeverityCUNILOG_TARGET (put, sev);
+}
+
+void ConfigCUNILOG_TARGETenableEventSeverity (CUNILOG_TARGET *put, cueventseverity sev)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+
+	enableSeverityCUNILOG_TARGET (put, sev);
+}
+
+void ConfigCUNILOG_TARGETdisableEventSeverities	(
+		CUNILOG_TARGET			*put,
+		unsigned int			n,
 		cueventseverity			*sevs
 												)
 {
@@ -2605,6 +3350,64 @@ void ConfigCUNILOG_TARGETenableEventSeverities	(
 	}
 }
 
+unsigned int cunilogEnableCallSitesInRangeByFile	(
+		CUNILOG_CALLSITE *const		*ppBegin,
+		CUNILOG_CALLSITE *const		*ppEnd,
+		const char					*szGlob,
+		size_t						lnGlob,
+		bool						bEnable
+													)
+{
+	ubf_assert_non_NULL	(szGlob);
+	ubf_assert			(ppBegin <= ppEnd);
+
+	unsigned int n = 0;
+	if (ppBegin)
+	{
+		lnGlob = USE_STRLEN == lnGlob ? strlen (szGlob) : lnGlob;
+		for (; ppBegin < ppEnd; ++ ppBegin)
+		{	// The MSVC linker may pad the section with NULL pointers.
+			if	(
+						*ppBegin
+					&&	matchWildcardPattern	(
+							(*ppBegin)->szFile, USE_STRLEN, szGlob, lnGlob
+												)
+				)
+			{
+				(*ppBegin)->bEnabled = bEnable ? 1 : 0;
+				++ n;
+			}
+		}
+	}
+	return n;
+}
+
+unsigned int cunilogEnableCallSitesInRangeBySeverity	(
+		CUNILOG_CALLSITE *const		*ppBegin,
+		CUNILOG_CALLSITE *const		*ppEnd,
+		cueventseverity				sev,
+		bool						bEnable
+														)
+{
+	ubf_assert			(0 <= sev);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sev);
+	ubf_assert			(ppBegin <= ppEnd);
+
+	unsigned int n = 0;
+	if (ppBegin)
+	{
+		for (; ppBegin < ppEnd; ++ ppBegin)
+		{	// The MSVC linker may pad the section with NULL pointers.
+			if (*ppBegin && sev == (*ppBegin)->sev)
+			{
+				(*ppBegin)->bEnabled = bEnable ? 1 : 0;
+				++ n;
+			}
+		}
+	}
+	return n;
+}
+
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	void EnterCUNILOG_TARGET (CUNILOG_TARGET *put)
 	{
@@ -2632,6 +3435,7 @@ void DoneCUNILOG_TARGETprocessors (CUNILOG_TARGET *put)
 	{
 		CUNILOG_ROTATION_DATA	*prd;
 		CUNILOG_CUSTPROCESS		*up;
+		CUNILOG_COLLAPSE_DATA	*pcd;
 	} upCust;
 
 	for (ui = 0; ui < np; ++ ui)
@@ -2646,12 +3450,17 @@ void DoneCUNILOG_TARGETprocessors (CUNILOG_TARGET *put)
 				break;
 			case cunilogProcessCustomProcessor:
 				upCust.up = cp->pData;
+				cunilogDoneCustBatch (cp);
 				if (upCust.up->procDone)
 					upCust.up->procDone (cp);
 				break;
 			case cunilogProcessTargetRedirector:
 			case cunilogProcessXAmountEnumValues:
 				break;
+			case cunilogProcessCollapseDuplicates:
+				upCust.pcd = cp->pData;
+				doneSMEMBUFuncond (&upCust.pcd->mbLast);
+				break;
 			case cunilogProcessWriteToLogFile:
 				cunilogCloseCUNILOG_LOGFILEifOpen (put);
 				break;
@@ -2719,13 +3528,28 @@ static void DoneCUNILOG_TARGETmembers (CUNILOG_TARGET *put)
 	// This is NULL for queues only.
 	if (put->mbLogEventLine.buf.pcc)
 		freeSMEMBUF (&put->mbLogEventLine);
+	if (put->mbJSONLine.buf.pcc)
+		freeSMEMBUF (&put->mbJSONLine);
 
-	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-		// This is NULL for queues only.
-		if (put->mbColEventLine.buf.pcc)
-			freeSMEMBUF (&put->mbColEventLine);
-	#endif
+	if (put->mbCoutBuf.buf.pcc)
+	{
+		cunilogFlushCoutBuffer (put);
+		freeSMEMBUF (&put->mbCoutBuf);
+	}
+	cunilogDoneCoutAsync (put);
 
+	if (put->psmpl)
+	{
+		ubf_free (put->psmpl);
+		put->psmpl = NULL;
+	}
+	if (put->pplan)
+	{
+		ubf_free (put->pplan);
+		put->pplan = NULL;
+	}
+	put->nplan = 0;
+	DoneCUNILOG_TARGETmbLogFold (put);
 	DoneSCUNILOGNPI (&put->scuNPI);
 	DoneCUNILOG_LOCKER (put);
 	DoneCUNILOG_TARGETqueuesemaphore (put);
@@ -2740,6 +3564,7 @@ CUNILOG_TARGET *DoneCUNILOG_TARGET (CUNILOG_TARGET *put)
 	ubf_assert_non_NULL (put);
 	ubf_assert (cunilogIsTargetInitialised (put));
 
+	cunilogRateLimitUnregisterAll (put);
 	DoneCUNILOG_TARGETprocessors (put);
 	DoneCUNILOG_TARGETmembers (put);
 	if (cunilogTargetHasTargetAllocatedFlag (put))
@@ -3463,6 +4288,138 @@ static size_t createCCEventLineFromCUNILOG_EVENT (CUNILOG_EVENT *pev)
 	return CUNILOG_SIZE_ERROR;
 }
 
+static size_t createFieldsEventLineFromCUNILOG_EVENT (CUNILOG_EVENT *pev);
+
+/*
+	The event line cache. When the data of an event is shared with other targets (see
+	cunilogShareCUNILOG_EVENT ()), the event that owns the data also keeps the event line
+	rendered by the first target. Other targets with the same event line layout copy the
+	line instead of rendering it again. The cache is created only once and never changed
+	afterwards. Its pointer is published atomically, since the targets might be processed
+	by different threads.
+*/
+static inline CUNILOG_LINE_CACHE *cunilogLoadLineCache (CUNILOG_EVENT *pevOwner)
+{
+	ubf_assert_non_NULL	(pevOwner);
+	ubf_assert_NULL		(pevOwner->pevOwner);
+
+	#ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		return pevOwner->plc;
+	#else
+		#if defined (_MSC_VER)
+			return InterlockedCompareExchangePointer ((PVOID volatile *) &pevOwner->plc, NULL, NULL);
+		#elif defined(__clang__) || defined(__GNUC__)
+			return __atomic_load_n (&pevOwner->plc, __ATOMIC_ACQUIRE);
+		#else
+			#error Not supported
+		#endif
+	#endif
+}
+
+/*
+	Returns true if plc has been stored, false if the event already has a cache.
+*/
+static inline bool cunilogStoreLineCache (CUNILOG_EVENT *pevOwner, CUNILOG_LINE_CACHE *plc)
+{
+	ubf_assert_non_NULL	(pevOwner);
+	ubf_assert_NULL		(pevOwner->pevOwner);
+	ubf_assert_non_NULL	(plc);
+
+	#ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pevOwner->plc)
+			return false;
+		pevOwner->plc = plc;
+		return true;
+	#else
+		#if defined (_MSC_VER)
+			return NULL == InterlockedCompareExchangePointer	(
+								(PVOID volatile *) &pevOwner->plc, plc, NULL
+																);
+		#elif defined(__clang__) || defined(__GNUC__)
+			CUNILOG_LINE_CACHE *pExp = NULL;
+			return __atomic_compare_exchange_n	(
+						&pevOwner->plc, &pExp, plc, false,
+						__ATOMIC_RELEASE, __ATOMIC_RELAXED
+												);
+		#else
+			#error Not supported
+		#endif
+	#endif
+}
+
+static inline bool cunilogLineCacheMatchesTarget (CUNILOG_LINE_CACHE *plc, CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL	(plc);
+	ubf_assert_non_NULL	(put);
+
+	return		plc->unilogEvtTSformat	== put->unilogEvtTSformat
+			&&	plc->severityPrefix		== put->severityPrefix
+			&&	plc->culogNewLine		== put->culogNewLine
+			&&	plc->dumpWidth			== put->dumpWidth;
+}
+
+/*
+	Stores the current event line of the event's target in the cache of the event that
+	owns the event's data, unless there's a cache already. To be called from a processor,
+	i.e. after the event line has been created.
+*/
+static void cunilogCacheEventLine (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
+
+	CUNILOG_TARGET	*put		= pev->pCUNILOG_TARGET;
+	CUNILOG_EVENT	*pevOwner	= pev->pevOwner ? pev->pevOwner : pev;
+
+	// Control codes are copied and not rendered.
+	if (cunilogEvtTypeControlCode == pev->evType)
+		return;
+	if (!isUsableSMEMBUF (&put->mbLogEventLine) || cunilogLoadLineCache (pevOwner))
+		return;
+
+	size_t				ln	= put->lnLogEventLine;
+	CUNILOG_LINE_CACHE	*plc = ubf_malloc (sizeof (CUNILOG_LINE_CACHE) + ln + 1);
+	if (plc)
+	{
+		plc->unilogEvtTSformat	= put->unilogEvtTSformat;
+		plc->severityPrefix		= put->severityPrefix;
+		plc->culogNewLine		= put->culogNewLine;
+		plc->dumpWidth			= put->dumpWidth;
+		plc->lnLine				= ln;
+		char *szLine = (char *) (plc + 1);
+		memcpy (szLine, put->mbLogEventLine.buf.pcc, ln);
+		szLine [ln] = ASCII_NUL;
+		if (!cunilogStoreLineCache (pevOwner, plc))
+			ubf_free (plc);
+	}
+}
+
+/*
+	Copies the event line from the cache of the event that owns the event's data if its
+	layout matches the event's target. Returns CUNILOG_SIZE_ERROR if it doesn't, or if
+	there's no cache.
+*/
+static size_t cunilogEventLineFromCache (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(pev->pevOwner);
+	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	CUNILOG_LINE_CACHE	*plc	= cunilogLoadLineCache (pev->pevOwner);
+
+	if (NULL == plc || !cunilogLineCacheMatchesTarget (plc, put))
+		return CUNILOG_SIZE_ERROR;
+
+	// Like when it's rendered, we reserve space for a new line sequence.
+	growToSizeSMEMBUF64aligned (&put->mbLogEventLine, plc->lnLine + eventLenNewline (pev) + 1);
+	if (!isUsableSMEMBUF (&put->mbLogEventLine))
+		return CUNILOG_SIZE_ERROR;
+	memcpy (put->mbLogEventLine.buf.pch, plc + 1, plc->lnLine + 1);
+	put->lnLogEventLine = plc->lnLine;
+	return put->lnLogEventLine;
+}
+
 static size_t createEventLineFromCUNILOG_EVENT (CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (pev);
@@ -3471,6 +4428,16 @@ static size_t createEventLineFromCUNILOG_EVENT (CUNILOG_EVENT *pev)
 
 	DBG_RESET_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker);
 
+	// A new event. Its JSON line is created when a processor requires it.
+	pev->pCUNILOG_TARGET->pevJSONLine = NULL;
+
+	if (pev->pevOwner)
+	{
+		size_t ln = cunilogEventLineFromCache (pev);
+		if (CUNILOG_SIZE_ERROR != ln)
+			return ln;
+	}
+
 	switch (pev->evType)
 	{
 		case cunilogEvtTypeNormalText:
@@ -3487,6 +4454,8 @@ static size_t createEventLineFromCUNILOG_EVENT (CUNILOG_EVENT *pev)
 		case cunilogEvtTypeHexDumpWithCaption32:
 		case cunilogEvtTypeHexDumpWithCaption64:
 			return createDumpEventLineFromCUNILOG_EVENT	(pev);
+		case cunilogEvtTypeFields:
+			return createFieldsEventLineFromCUNILOG_EVENT (pev);
 		default:
 			break;
 	}
@@ -3769,253 +4738,1456 @@ CUNILOG_EVENT *CreateCUNILOG_EVENT_TextTS		(
 	return pev;
 }
 
-CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
+CUNILOG_EVENT *CreateCUNILOG_EVENT_TextV	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const CUNILOG_FRAGMENT		*pfr,
+					size_t						nfr
+											)
 {
-	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(pfr || 0 == nfr);
 
-	size_t size;
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+		return NULL;
+
+	size_t			len		= 0;
+	size_t			n;
+	for (n = 0; n < nfr; ++ n)
+	{
+		ubf_assert_non_NULL (pfr [n].ccText);
+		len += USE_STRLEN == pfr [n].len ? strlen (pfr [n].ccText) : pfr [n].len;
+	}
+
+	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+	size_t			ln		= aln + len;
+	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+
+	if (pev)
+	{
+		unsigned char	*pData	= (unsigned char *) pev + aln;
+		unsigned char	*pOut	= pData;
+		size_t			l;
+
+		for (n = 0; n < nfr; ++ n)
+		{
+			l = USE_STRLEN == pfr [n].len ? strlen (pfr [n].ccText) : pfr [n].len;
+			memcpy (pOut, pfr [n].ccText, l);
+			pOut += l;
+		}
+		len = strRemoveLineEndingsFromEnd ((const char *) pData, len);
+
+		UBF_TIMESTAMP	ts	=		cunilogHasEnqueueTimestamps	(put)
+								&&	HAS_CUNILOG_TARGET_A_QUEUE	(put)
+							?	0
+							:	LocalTime_UBF_TIMESTAMP ();
+		FillCUNILOG_EVENT	(
+			pev, put,
+			CUNILOGEVENT_ALLOCATED,
+			ts,
+			sev, cunilogEvtTypeNormalText,
+			pData, len, ln
+							);
+	}
+	return pev;
+}
+
+/*
+	Writes the floating point value d with nDec decimals to sz, without using printf ().
+	Values too large for a 64 bit integer, infinities, and NaNs fall back to snprintf (),
+	which is not expected to happen in the common case.
+
+	The buffer sz points to must be at least CUNILOG_ARG_FLT_SIZE (nDec) octets long.
+	The function returns the amount of characters written, not counting the NUL.
+*/
+#define CUNILOG_ARG_FLT_SIZE(nDec)	(1 + UBF_UINT64_LEN + 1 + (nDec) + 1)
+
+static size_t cunilogStrFromDouble (char *sz, double d, size_t nDec)
+{
+	ubf_assert_non_NULL	(sz);
+	ubf_assert			(nDec <= CUNILOG_ARG_FLT_MAX_DECIMALS);
+
+	static const uint64_t	auiPow10 [CUNILOG_ARG_FLT_MAX_DECIMALS + 1] =
+	{
+		UINT64_C (1),				UINT64_C (10),				UINT64_C (100),
+		UINT64_C (1000),			UINT64_C (10000),			UINT64_C (100000),
+		UINT64_C (1000000),			UINT64_C (10000000),		UINT64_C (100000000),
+		UINT64_C (1000000000),		UINT64_C (10000000000),		UINT64_C (100000000000),
+		UINT64_C (1000000000000),	UINT64_C (10000000000000),	UINT64_C (100000000000000),
+		UINT64_C (1000000000000000)
+	};
+
+	if (!(d > -1e18 && d < 1e18))
+	{	// Also true for NaN.
+		int i = snprintf (sz, CUNILOG_ARG_FLT_SIZE (nDec), "%g", d);
+		return i > 0 ? (size_t) i : 0;
+	}
+
+	size_t		o		= 0;
+	if (d < 0)
+	{
+		sz [o ++] = '-';
+		d = -d;
+	}
+	uint64_t	ip		= (uint64_t) d;
+	uint64_t	fp		= (uint64_t) ((d - (double) ip) * (double) auiPow10 [nDec] + 0.5);
+	if (fp >= auiPow10 [nDec])
+	{	// Rounding carried over, for instance 0.9999999.
+		++ ip;
+		fp -= auiPow10 [nDec];
+	}
+	o += ubf_str_from_uint64 (sz + o, ip);
+	if (nDec)
+	{
+		sz [o ++] = '.';
+		// Returns the amount of significant digits, not the amount written.
+		ubf_str0_from_uint64 (sz + o, nDec, fp);
+		o += nDec;
+	}
+	return o;
+}
+
+static inline size_t cunilogArgLen (const CUNILOG_ARG *pa)
+{
+	ubf_assert_non_NULL	(pa);
+
+	switch (pa->type)
+	{
+		case cunilogArgTypeStr:
+			ubf_assert_non_NULL (pa->v.cc);
+			return USE_STRLEN == pa->len ? strlen (pa->v.cc) : pa->len;
+		case cunilogArgTypeI64:	return UBF_INT64_LEN;
+		case cunilogArgTypeU64:	return UBF_UINT64_LEN;
+		case cunilogArgTypeHex:	return UBF_HEX64_STRSIZ - 1;
+		case cunilogArgTypeFlt:	return CUNILOG_ARG_FLT_SIZE (pa->len) - 1;
+		default:
+			ubf_assert_msg (false, "Not supported");
+			return 0;
+	}
+}
+
+/*
+	Writes the argument pa points to to sz and returns the amount of characters written.
+	The function may write a NUL character after them.
+*/
+static inline size_t cunilogStrFromArg (char *sz, const CUNILOG_ARG *pa, size_t lnStr)
+{
+	ubf_assert_non_NULL	(sz);
+	ubf_assert_non_NULL	(pa);
+
+	switch (pa->type)
+	{
+		case cunilogArgTypeStr:
+			memcpy (sz, pa->v.cc, lnStr);
+			return lnStr;
+		case cunilogArgTypeI64:	return ubf_str_from_int64 (sz, pa->v.i64);
+		case cunilogArgTypeU64:	return ubf_str_from_uint64 (sz, pa->v.u64);
+		case cunilogArgTypeHex:
+			ubf_hex_from_qword (sz, pa->v.u64);
+			return UBF_HEX64_STRSIZ - 1;
+		case cunilogArgTypeFlt:	return cunilogStrFromDouble (sz, pa->v.dbl, pa->len);
+		default:
+			ubf_assert_msg (false, "Not supported");
+			return 0;
+	}
+}
+
+/*
+	Structured events of type cunilogEvtTypeFields. The message text is followed by the
+	amount of fields as an uint32_t and the fields. Each field consists of:
+
+	uint32_t		Length of the key.
+	char []			The key, not NUL-terminated.
+	uint8_t			The type of the value (cunilogargtype).
+	uint8_t			The amount of decimals for cunilogArgTypeFlt, otherwise 0.
+	uint32_t		For cunilogArgTypeStr only: the length of the string.
+	char []	or		For cunilogArgTypeStr: the string, not NUL-terminated.
+	8 octets		For all other types: the int64_t, uint64_t, or double value.
+
+	Nothing is aligned. Values are therefore copied with memcpy ().
+*/
+static inline size_t cunilogSerialisedFieldSize	(
+						size_t					*plnKey,
+						size_t					*plnVal,
+						const CUNILOG_FIELD		*pf
+												)
+{
+	ubf_assert_non_NULL	(plnKey);
+	ubf_assert_non_NULL	(plnVal);
+	ubf_assert_non_NULL	(pf);
+	ubf_assert_non_NULL	(pf->ccKey);
+
+	*plnKey = USE_STRLEN == pf->lenKey ? strlen (pf->ccKey) : pf->lenKey;
+	ubf_assert (*plnKey <= UINT32_MAX);
+	if (cunilogArgTypeStr == pf->val.type)
+	{
+		*plnVal = cunilogArgLen (&pf->val);
+		ubf_assert (*plnVal <= UINT32_MAX);
+		return sizeof (uint32_t) + *plnKey + 2 + sizeof (uint32_t) + *plnVal;
+	}
+	*plnVal = sizeof (uint64_t);
+	return sizeof (uint32_t) + *plnKey + 2 + sizeof (uint64_t);
+}
+
+static inline unsigned char *cunilogSerialiseField	(
+						unsigned char			*p,
+						const CUNILOG_FIELD		*pf,
+						size_t					lnKey,
+						size_t					lnVal
+													)
+{
+	ubf_assert_non_NULL	(p);
+	ubf_assert_non_NULL	(pf);
+
+	uint32_t	ui32	= (uint32_t) lnKey;
+	memcpy (p, &ui32, sizeof (uint32_t));
+	p += sizeof (uint32_t);
+	memcpy (p, pf->ccKey, lnKey);
+	p += lnKey;
+	*p ++ = (unsigned char) pf->val.type;
+	*p ++ = (unsigned char) (cunilogArgTypeFlt == pf->val.type ? pf->val.len : 0);
+	switch (pf->val.type)
+	{
+		case cunilogArgTypeStr:
+			ui32 = (uint32_t) lnVal;
+			memcpy (p, &ui32, sizeof (uint32_t));
+			p += sizeof (uint32_t);
+			memcpy (p, pf->val.v.cc, lnVal);
+			return p + lnVal;
+		case cunilogArgTypeI64:
+			memcpy (p, &pf->val.v.i64, sizeof (int64_t));
+			return p + sizeof (int64_t);
+		case cunilogArgTypeFlt:
+			memcpy (p, &pf->val.v.dbl, sizeof (double));
+			return p + sizeof (double);
+		default:
+			memcpy (p, &pf->val.v.u64, sizeof (uint64_t));
+			return p + sizeof (uint64_t);
+	}
+}
+
+/*
+	Reads the field at p into pf. Its pointers point into the event. Returns a pointer
+	to the next field.
+*/
+static inline const unsigned char *cunilogDeserialiseField	(
+						CUNILOG_FIELD			*pf,
+						const unsigned char		*p
+															)
+{
+	ubf_assert_non_NULL	(pf);
+	ubf_assert_non_NULL	(p);
+
+	uint32_t	ui32;
+	memcpy (&ui32, p, sizeof (uint32_t));
+	p += sizeof (uint32_t);
+	pf->ccKey		= (const char *) p;
+	pf->lenKey		= ui32;
+	p += ui32;
+	pf->val.type	= (cunilogargtype) *p ++;
+	pf->val.len		= *p ++;
+	switch (pf->val.type)
+	{
+		case cunilogArgTypeStr:
+			memcpy (&ui32, p, sizeof (uint32_t));
+			p += sizeof (uint32_t);
+			pf->val.v.cc	= (const char *) p;
+			pf->val.len		= ui32;
+			return p + ui32;
+		case cunilogArgTypeI64:
+			memcpy (&pf->val.v.i64, p, sizeof (int64_t));
+			return p + sizeof (int64_t);
+		case cunilogArgTypeFlt:
+			memcpy (&pf->val.v.dbl, p, sizeof (double));
+			return p + sizeof (double);
+		default:
+			memcpy (&pf->val.v.u64, p, sizeof (uint64_t));
+			return p + sizeof (uint64_t);
+	}
+}
+
+/*
+	Returns the amount of fields of the structured event pev points to and their start
+	in *pp.
+*/
+static inline uint32_t cunilogFieldsOfEvent (const unsigned char **pp, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pp);
+	ubf_assert_non_NULL	(pev);
+	ubf_assert			(cunilogEvtTypeFields == pev->evType);
+
+	uint32_t	nf;
+	memcpy (&nf, pev->szDataToLog + pev->lenDataToLog, sizeof (uint32_t));
+	*pp = pev->szDataToLog + pev->lenDataToLog + sizeof (uint32_t);
+	return nf;
+}
+
+CUNILOG_EVENT *CreateCUNILOG_EVENT_Fields	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccMsg,
+					size_t						lenMsg,
+					const CUNILOG_FIELD			*pf,
+					size_t						nf
+											)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(ccMsg);
+	ubf_assert			(pf || 0 == nf);
+	ubf_assert			(nf <= UINT32_MAX);
+
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+		return NULL;
+
+	lenMsg = USE_STRLEN == lenMsg ? strlen (ccMsg) : lenMsg;
+	lenMsg = strRemoveLineEndingsFromEnd (ccMsg, lenMsg);
+
+	size_t			lnKey;
+	size_t			lnVal;
+	size_t			len		= lenMsg + sizeof (uint32_t);
+	size_t			n;
+	for (n = 0; n < nf; ++ n)
+		len += cunilogSerialisedFieldSize (&lnKey, &lnVal, pf + n);
+
+	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+	size_t			ln		= aln + len;
+	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+
+	if (pev)
+	{
+		unsigned char	*pData	= (unsigned char *) pev + aln;
+		unsigned char	*p		= pData;
+		uint32_t		ui32	= (uint32_t) nf;
+
+		memcpy (p, ccMsg, lenMsg);
+		p += lenMsg;
+		memcpy (p, &ui32, sizeof (uint32_t));
+		p += sizeof (uint32_t);
+		for (n = 0; n < nf; ++ n)
+		{
+			cunilogSerialisedFieldSize (&lnKey, &lnVal, pf + n);
+			p = cunilogSerialiseField (p, pf + n, lnKey, lnVal);
+		}
+		ubf_assert ((size_t) (p - pData) == len);
+
+		UBF_TIMESTAMP	ts	=		cunilogHasEnqueueTimestamps	(put)
+								&&	HAS_CUNILOG_TARGET_A_QUEUE	(put)
+							?	0
+							:	LocalTime_UBF_TIMESTAMP ();
+		FillCUNILOG_EVENT	(
+			pev, put,
+			CUNILOGEVENT_ALLOCATED,
+			ts,
+			sev, cunilogEvtTypeFields,
+			pData, lenMsg, ln
+							);
+	}
+	return pev;
+}
+
+/*
+	The event line of a structured event is the message text followed by the fields in the
+	form " key=value".
+*/
+static size_t createFieldsEventLineFromCUNILOG_EVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
+	ubf_assert			(cunilogEvtTypeFields == pev->evType);
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	const unsigned char	*p;
+	uint32_t			nf		= cunilogFieldsOfEvent (&p, pev);
+	CUNILOG_FIELD		fld;
+	uint32_t			n;
+
+	size_t	r	=		requiredEvtLineTimestampAndSeverityLength (pev)
+					+	pev->lenDataToLog
+					+	requiredFullstopChars (pev)
+					+	eventLenNewline (pev)
+					+	1;
+	for (n = 0; n < nf; ++ n)
+	{
+		p = cunilogDeserialiseField (&fld, p);
+		r += 2 + fld.lenKey + cunilogArgLen (&fld.val);
+	}
+
+	growToSizeSMEMBUF64aligned (&put->mbLogEventLine, r);
+	if (!isUsableSMEMBUF (&put->mbLogEventLine))
+		return CUNILOG_SIZE_ERROR;
+
+	char	*szOut	= put->mbLogEventLine.buf.pch;
+	char	*szOrg	= szOut;
+
+	evtTSFormats [put->unilogEvtTSformat].fnc (szOut, pev->stamp);
+	szOut += evtTSFormats [put->unilogEvtTSformat].len;
+	szOut += writeEventSeverity (szOut, pev->evSeverity, put->severityPrefix);
+	memcpy (szOut, pev->szDataToLog, pev->lenDataToLog);
+	szOut += pev->lenDataToLog;
+	szOut += writeFullStop (szOut, pev);
+
+	cunilogFieldsOfEvent (&p, pev);
+	for (n = 0; n < nf; ++ n)
+	{
+		p = cunilogDeserialiseField (&fld, p);
+		*szOut ++ = ' ';
+		memcpy (szOut, fld.ccKey, fld.lenKey);
+		szOut += fld.lenKey;
+		*szOut ++ = '=';
+		szOut += cunilogStrFromArg (szOut, &fld.val, fld.val.len);
+	}
+	szOut [0] = ASCII_NUL;
+	put->lnLogEventLine = szOut - szOrg;
+	return put->lnLogEventLine;
+}
+
+/*
+	JSON Lines.
+
+	Creates the JSON line of the event pev points to in the target's mbJSONLine buffer,
+	for instance:
+
+	{"ts":"2026-10-19T14:03:11.250+01:00","sev":"INFO","msg":"Request","status":200}
+
+	The member "sev" is omitted for severities without text. The fields of structured events
+	follow the member "msg". For hex dumps, "msg" is the event line without timestamp and
+	severity. The line is created only once per event, even if several processors require
+	it. It is NUL-terminated and has room for a line ending.
+
+	The function returns the length of the JSON line, or CUNILOG_SIZE_ERROR if the buffer
+	could not be allocated.
+*/
+static size_t cunilogJSONLineFromEvent (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
+	ubf_assert			(cunilogEvtTypeControlCode != pev->evType);
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	if (pev == put->pevJSONLine)
+		return put->lnJSONLine;
+
+	const char			*ccMsg;
+	size_t				lnMsg;
+	const unsigned char	*p		= NULL;
+	uint32_t			nf		= 0;
+	CUNILOG_FIELD		fld;
+	uint32_t			n;
+
+	if (cunilogEvtTypeNormalText == pev->evType || cunilogEvtTypeFields == pev->evType)
+	{
+		ccMsg	= (const char *) pev->szDataToLog;
+		lnMsg	= pev->lenDataToLog;
+	} else
+	{
+		size_t o = requiredEvtLineTimestampAndSeverityLength (pev);
+		o		= o < put->lnLogEventLine ? o : put->lnLogEventLine;
+		ccMsg	= put->mbLogEventLine.buf.pcc + o;
+		lnMsg	= put->lnLogEventLine - o;
+	}
+
+	// {"ts":"...","sev":"...","msg":"..."} plus a line ending and NUL.
+	size_t	r	=		64 + LEN_ISO8601DATETIMESTAMPMS
+					+	STRJSON_MAX_ESCAPED_LEN (lnMsg)
+					+	eventLenNewline (pev);
+	if (cunilogEvtTypeFields == pev->evType)
+	{
+		nf = cunilogFieldsOfEvent (&p, pev);
+		for (n = 0; n < nf; ++ n)
+		{
+			p = cunilogDeserialiseField (&fld, p);
+			r += 4 + STRJSON_MAX_ESCAPED_LEN (fld.lenKey) + 2;
+			r +=	cunilogArgTypeStr == fld.val.type
+				?	STRJSON_MAX_ESCAPED_LEN (fld.val.len)
+				:	cunilogArgLen (&fld.val) + 1;
+		}
+	}
+
+	growToSizeSMEMBUF64aligned (&put->mbJSONLine, r);
+	if (!isUsableSMEMBUF (&put->mbJSONLine))
+		return CUNILOG_SIZE_ERROR;
+
+	char		*szOut	= put->mbJSONLine.buf.pch;
+	char		*szOrg	= szOut;
+	const char	*szSev	= EvtSevTexts [pev->evSeverity].texts9tgt;
+	size_t		lnSev	= strlen (szSev);
+
+	memcpy (szOut, "{\"ts\":\"", 7);
+	szOut += 7;
+	ISO8601T_from_UBF_TIMESTAMP (szOut, pev->stamp);
+	szOut += LEN_ISO8601DATETIMESTAMPMS;
+	*szOut ++ = '"';
+	if (lnSev)
+	{
+		memcpy (szOut, ",\"sev\":\"", 8);
+		szOut += 8;
+		memcpy (szOut, szSev, lnSev);
+		szOut += lnSev;
+		*szOut ++ = '"';
+	}
+	memcpy (szOut, ",\"msg\":\"", 8);
+	szOut += 8;
+	szOut += strJSONescape (szOut, ccMsg, lnMsg);
+	*szOut ++ = '"';
+
+	if (nf)
+		cunilogFieldsOfEvent (&p, pev);
+	for (n = 0; n < nf; ++ n)
+	{
+		p = cunilogDeserialiseField (&fld, p);
+		memcpy (szOut, ",\"", 2);
+		szOut += 2;
+		szOut += strJSONescape (szOut, fld.ccKey, fld.lenKey);
+		memcpy (szOut, "\":", 2);
+		szOut += 2;
+		switch (fld.val.type)
+		{
+			case cunilogArgTypeStr:
+				*szOut ++ = '"';
+				szOut += strJSONescape (szOut, fld.val.v.cc, fld.val.len);
+				*szOut ++ = '"';
+				break;
+			case cunilogArgTypeHex:
+				*szOut ++ = '"';
+				szOut += cunilogStrFromArg (szOut, &fld.val, 0);
+				*szOut ++ = '"';
+				break;
+			case cunilogArgTypeFlt:
+				// JSON has no representation for NaN and the infinities.
+				if (fld.val.v.dbl != fld.val.v.dbl || fld.val.v.dbl - fld.val.v.dbl != 0)
+				{
+					memcpy (szOut, "null", 4);
+					szOut += 4;
+					break;
+				}
+				szOut += cunilogStrFromArg (szOut, &fld.val, 0);
+				break;
+			default:
+				szOut += cunilogStrFromArg (szOut, &fld.val, 0);
+				break;
+		}
+	}
+	*szOut ++ = '}';
+	szOut [0] = ASCII_NUL;
+	ubf_assert ((size_t) (szOut - szOrg) < r);
+
+	put->lnJSONLine		= szOut - szOrg;
+	put->pevJSONLine	= pev;
+	return put->lnJSONLine;
+}
+
+CUNILOG_EVENT *CreateCUNILOG_EVENT_Args	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const CUNILOG_ARG			*pa,
+					size_t						na
+											)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(pa || 0 == na);
+
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+		return NULL;
+
+	// The maximum length of every argument. No formatting pass is required for this.
+	size_t			len		= 0;
+	size_t			n;
+	for (n = 0; n < na; ++ n)
+	{
+		ubf_assert	(
+						cunilogArgTypeFlt != pa [n].type
+					||	CUNILOG_ARG_FLT_MAX_DECIMALS >= pa [n].len
+					);
+		len += cunilogArgLen (pa + n);
+	}
+
+	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+	// The converters write a NUL after the last argument.
+	size_t			ln		= aln + len + 1;
+	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+
+	if (pev)
+	{
+		unsigned char	*pData	= (unsigned char *) pev + aln;
+		char			*pOut	= (char *) pData;
+
+		for (n = 0; n < na; ++ n)
+		{
+			size_t lnStr = cunilogArgTypeStr == pa [n].type ? cunilogArgLen (pa + n) : 0;
+			pOut += cunilogStrFromArg (pOut, pa + n, lnStr);
+		}
+		len = strRemoveLineEndingsFromEnd ((const char *) pData, (size_t) (pOut - (char *) pData));
+
+		UBF_TIMESTAMP	ts	=		cunilogHasEnqueueTimestamps	(put)
+								&&	HAS_CUNILOG_TARGET_A_QUEUE	(put)
+							?	0
+							:	LocalTime_UBF_TIMESTAMP ();
+		FillCUNILOG_EVENT	(
+			pev, put,
+			CUNILOGEVENT_ALLOCATED,
+			ts,
+			sev, cunilogEvtTypeNormalText,
+			pData, len, ln
+							);
+	}
+	return pev;
+}
+
+CUNILOG_EVENT *CreateCUNILOG_EVENT_TextRef	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccText,
+					size_t						len
+											)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(ccText);
+
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+		return NULL;
+
+	len = USE_STRLEN == len ? strlen (ccText) : len;
+	len = strRemoveLineEndingsFromEnd (ccText, len);
+
+	// Only the structure. The text stays where it is.
+	CUNILOG_EVENT	*pev	= ubf_malloc (sizeof (CUNILOG_EVENT));
+	if (pev)
+	{
+		UBF_TIMESTAMP	ts	=		cunilogHasEnqueueTimestamps	(put)
+								&&	HAS_CUNILOG_TARGET_A_QUEUE	(put)
+							?	0
+							:	LocalTime_UBF_TIMESTAMP ();
+		FillCUNILOG_EVENT	(
+			pev, put,
+			CUNILOGEVENT_ALLOCATED | CUNILOGEVENT_DATA_BY_REFERENCE,
+			ts,
+			sev, cunilogEvtTypeNormalText,
+			(unsigned char *) ccText, len, sizeof (CUNILOG_EVENT)
+							);
+	}
+	return pev;
+}
+
+/*
+	Reference counting of event data that is shared between events. The member nRefs of
+	the event that owns the data only counts the additional references, i.e. it is 0 for
+	an event whose data is not shared.
+*/
+static inline void cunilogRetainEventData (CUNILOG_EVENT *pevOwner)
+{
+	ubf_assert_non_NULL	(pevOwner);
+	ubf_assert_NULL		(pevOwner->pevOwner);
+
+	#ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		++ pevOwner->nRefs;
+	#else
+		#if defined (_MSC_VER)
+			InterlockedIncrement ((volatile LONG *) &pevOwner->nRefs);
+		#elif defined(__clang__) || defined(__GNUC__)
+			__atomic_fetch_add (&pevOwner->nRefs, 1, __ATOMIC_RELAXED);
+		#else
+			#error Not supported
+		#endif
+	#endif
+}
+
+/*
+	Returns true if the caller has released the last reference to the data of the event
+	pevOwner points to, in which case the caller destroys the event.
+*/
+static inline bool cunilogReleaseEventData (CUNILOG_EVENT *pevOwner)
+{
+	ubf_assert_non_NULL	(pevOwner);
+	ubf_assert_NULL		(pevOwner->pevOwner);
+
+	uint32_t uiPrev;
+
+	// The counter is only decremented if it isn't 0 already, i.e. if the data is shared.
+	#ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		uiPrev = pevOwner->nRefs;
+		if (uiPrev)
+			-- pevOwner->nRefs;
+	#else
+		#if defined (_MSC_VER)
+			LONG lPrev;
+			uiPrev = (uint32_t) InterlockedCompareExchange ((volatile LONG *) &pevOwner->nRefs, 0, 0);
+			while (uiPrev)
+			{
+				lPrev = InterlockedCompareExchange	(
+							(volatile LONG *) &pevOwner->nRefs, (LONG) (uiPrev - 1), (LONG) uiPrev
+													);
+				if ((uint32_t) lPrev == uiPrev)
+					break;
+				uiPrev = (uint32_t) lPrev;
+			}
+		#elif defined(__clang__) || defined(__GNUC__)
+			uiPrev = __atomic_load_n (&pevOwner->nRefs, __ATOMIC_ACQUIRE);
+			while	(
+							uiPrev
+						&&	!__atomic_compare_exchange_n	(
+								&pevOwner->nRefs, &uiPrev, uiPrev - 1,
+								false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+															)
+					)
+				;
+		#else
+			#error Not supported
+		#endif
+	#endif
+	return 0 == uiPrev;
+}
+
+CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+
+	size_t size;
+
+	if (pev->sizEvent)
+		size = pev->sizEvent;
+	else
+		size = sizeof (CUNILOG_EVENT);
+	CUNILOG_EVENT *pnev = ubf_malloc (size);
+	if (pnev)
+	{
+		memcpy (pnev, pev, size);
+		cunilogSetEventAllocated (pnev);
+		// Data that follows the structure belongs to the copy.
+		if	(
+					(unsigned char *) pev->szDataToLog >= (unsigned char *) pev
+				&&	(unsigned char *) pev->szDataToLog <  (unsigned char *) pev + size
+			)
+		{
+			pnev->szDataToLog = (unsigned char *) pnev + (pev->szDataToLog - (unsigned char *) pev);
+		}
+		pnev->nRefs = 0;
+		pnev->plc	= NULL;
+		if (pnev->pevOwner)
+			cunilogRetainEventData (pnev->pevOwner);
+	}
+	return pnev;
+}
+
+CUNILOG_EVENT *cunilogShareCUNILOG_EVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+
+	// We can only keep the data of an event alive that is going to be destroyed by
+	//	DoneCUNILOG_EVENT ().
+	if (!cunilogIsEventAllocated (pev))
+		return DuplicateCUNILOG_EVENT (pev);
+
+	CUNILOG_EVENT *pnev = ubf_malloc (sizeof (CUNILOG_EVENT));
+	if (pnev)
+	{
+		memcpy (pnev, pev, sizeof (CUNILOG_EVENT));
+		pnev->uiOpts	&= ~ CUNILOGEVENT_DATA_ALLOCATED;
+		pnev->uiOpts	|= CUNILOGEVENT_ALLOCATED;
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			pnev->next	= NULL;
+		#endif
+		pnev->sizEvent	= sizeof (CUNILOG_EVENT);
+		pnev->nRefs		= 0;
+		pnev->plc		= NULL;
+		pnev->pevOwner	= pev->pevOwner ? pev->pevOwner : pev;
+		cunilogRetainEventData (pnev->pevOwner);
+	}
+	return pnev;
+}
+
+static void cunilogDestroyCUNILOG_EVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+
+	if (pev->szDataToLog && cunilogIsEventDataAllocated (pev))
+	{
+		ubf_free ((char *) pev->szDataToLog);
+	}
+	if (pev->plc)
+	{
+		ubf_free (pev->plc);
+	}
+	if (cunilogIsEventAllocated (pev))
+	{
+		ubf_free (pev);
+	}
+}
+
+CUNILOG_EVENT *DoneCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+{
+	if (NULL == put || put == pev->pCUNILOG_TARGET)
+	{
+		CUNILOG_EVENT *pevOwner = pev->pevOwner;
+
+		if (pevOwner)
+		{	// Only the structure is ours. The data belongs to pevOwner.
+			ubf_assert (cunilogIsEventAllocated (pev));
+			ubf_free (pev);
+			pev = pevOwner;
+		}
+		if (cunilogReleaseEventData (pev))
+			cunilogDestroyCUNILOG_EVENT (pev);
+	}
+	return NULL;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put);
+#endif
+
+#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
+	void cunilogSetTargetErrorAndInvokeErrorCallback	(
+			CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
+														)
+	{
+		ubf_assert_non_NULL (cup);
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+		#ifdef PLATFORM_IS_WINDOWS
+			DWORD syserror = GetLastError ();
+		#else
+			int32_t syserror = errno;
+		#endif
+		SetCunilogError (pev->pCUNILOG_TARGET, cunilog_error, syserror);
+
+		if (pev->pCUNILOG_TARGET->errorCB)
+		{
+			errCBretval rv = pev->pCUNILOG_TARGET->errorCB (pev->pCUNILOG_TARGET->error, cup, pev);
+			ubf_assert (0 <= rv);
+			ubf_assert (cunilogErrCB_AmountEnumValues > rv);
+
+			#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+				CUNILOG_EVENT *pve;
+				CUNILOG_EVENT *nxt;
+			#endif
+
+			switch (rv)
+			{
+				case cunilogErrCB_ignore:
+					break;
+				case cunilogErrCB_next_processor:
+					break;
+				case cunilogErrCB_next_event:
+					cunilogEventSetIgnoreRemainingProcessors (pev);
+					break;
+				case cunilogErrCB_shutdown:
+					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
+					break;
+				case cunilogErrCB_cancel:
+					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
+					#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+						pve = DequeueAllCUNILOG_EVENTs (pev->pCUNILOG_TARGET);
+						while (pve)
+						{
+							nxt = pve->next;
+							DoneCUNILOG_EVENT (NULL, pve);
+							pve = nxt;
+						}
+					#endif
+					break;
+				default:
+					ubf_assert (false);
+					break;
+			}
+		}
+	}
+
+	/*
+		cunilogTestErrorCB
+	*/
+	#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
+		void cunilogTestErrorCB	(
+				CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
+								)
+		{
+			ubf_assert_non_NULL (cup);
+			ubf_assert_non_NULL (pev);
+			ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+			if (cunilogTargetHasAlwaysCallErrorCB (pev->pCUNILOG_TARGET))
+			{
+				errCBretval rv = pev->pCUNILOG_TARGET->errorCB	(
+										cunilog_error, cup, pev
+																);
+				UNUSED (rv);
+				ubf_assert (0 <= rv);
+				ubf_assert (cunilogErrCB_AmountEnumValues > rv);
+			}
+		}
+	#else
+		#define cunilogTestErrorCB(error, cup, pev)
+	#endif
+#else
+	#define cunilogInvokeErrorCallback(error, cup, pev)
+	#define cunilogTestErrorCB(error, cup, pev)
+#endif
+
+/*
+	The dummy/no-operation processor.
+*/
+static bool cunilogProcessNoneFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	UNREFERENCED_PARAMETER (cup);
+	UNREFERENCED_PARAMETER (pev);
+
+	return true;
+}
 
-	if (pev->sizEvent)
-		size = pev->sizEvent;
-	else
-		size = sizeof (CUNILOG_EVENT);
-	CUNILOG_EVENT *pnev = ubf_malloc (size);
-	if (pnev)
+#ifdef PLATFORM_IS_WINDOWS
+	static inline int cunilogPutsWin (const char *szOutput, size_t len)
 	{
-		memcpy (pnev, pev, size);
-		cunilogSetEventAllocated (pnev);
+		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
+			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
+		CunilogEnableANSIifNotInitialised ();
+
+		if (len)
+		{	// These functions expect a NUL-terminated string.
+			ubf_assert (strlen (szOutput) == len);
+			ubf_assert (ASCII_NUL == szOutput [len]);
+
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return puts					(szOutput);
+				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	(szOutput);
+				case cunilogConsoleIsNeither:	return puts					(szOutput);
+				default:						return puts					(szOutput);
+			}
+		} else
+		{
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return puts					("");
+				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	("");
+				case cunilogConsoleIsNeither:	return puts					("");
+				default:						return puts					("");
+			}
+		}
 	}
-	return pnev;
+#endif
+
+#ifdef PLATFORM_IS_WINDOWS
+	static inline int cunilogPrintWin (const char *szOutput, size_t len)
+	{
+		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
+			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
+		CunilogEnableANSIifNotInitialised ();
+
+		if (len)
+		{	// These functions expect a NUL-terminated string.
+			ubf_assert (strlen (szOutput) == len);
+			ubf_assert (ASCII_NUL == szOutput [len]);
+
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return printf				(szOutput);
+				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, szOutput);
+				case cunilogConsoleIsNeither:	return printf				(szOutput);
+				default:						return printf				(szOutput);
+			}
+		} else
+		{
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return printf				("");
+				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, "");
+				case cunilogConsoleIsNeither:	return printf				("");
+				default:						return printf				("");
+			}
+		}
+	}
+#endif
+
+/*
+	Console output consists of the fragments colour sequence, event line, and reset sequence.
+	The event line is output directly from the buffer it has been created in. Fragments that
+	aren't required have a length of 0.
+*/
+enum cunilogcoutfragment
+{
+		cunilogCoutFragColour
+	,	cunilogCoutFragLine
+	,	cunilogCoutFragReset
+	,	cunilogCoutFragXAmountEnumValues
+};
+
+static inline void cunilogFillCoutFragments	(
+						CUNILOG_FRAGMENT	afr [cunilogCoutFragXAmountEnumValues],
+						const char			*szLine,
+						size_t				lnLine,
+						CUNILOG_EVENT		*pev
+											)
+{
+	ubf_assert_non_NULL (afr);
+	ubf_assert_non_NULL (szLine);
+	ubf_assert_non_NULL (pev);
+
+	afr [cunilogCoutFragColour].ccText	= "";
+	afr [cunilogCoutFragColour].len		= 0;
+	afr [cunilogCoutFragLine].ccText	= szLine;
+	afr [cunilogCoutFragLine].len		= lnLine;
+	afr [cunilogCoutFragReset].ccText	= "";
+	afr [cunilogCoutFragReset].len		= 0;
+
+	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
+		if	(
+					cunilogTargetHasUseColourForCout (pev->pCUNILOG_TARGET)
+				&&	evtSeverityColours [pev->evSeverity].lnColSequence
+			)
+		{
+			afr [cunilogCoutFragColour].ccText	= evtSeverityColours [pev->evSeverity].szColSequence;
+			afr [cunilogCoutFragColour].len		= evtSeverityColours [pev->evSeverity].lnColSequence;
+			afr [cunilogCoutFragReset].ccText	= STR_ANSI_RESET;
+			afr [cunilogCoutFragReset].len		= LEN_ANSI_RESET;
+		}
+	#endif
 }
 
-CUNILOG_EVENT *DoneCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+/*
+	Buffered console output. See ConfigCUNILOG_TARGETcoutBuffered ().
+*/
+#ifdef PLATFORM_IS_WINDOWS
+	#define CUNILOG_COUT_NEWLINE			"\r\n"
+#else
+	#define CUNILOG_COUT_NEWLINE			"\n"
+#endif
+#define CUNILOG_COUT_NEWLINE_LEN		(sizeof (CUNILOG_COUT_NEWLINE) - 1)
+
+/*
+	Writes the buffered console output to stdout with a single call if possible.
+	Returns false if this fails. The buffer is emptied in either case.
+*/
+static bool cunilogWriteToStdout (const char *pData, size_t lnData);
+
+static bool cunilogFlushCoutBuffer (CUNILOG_TARGET *put)
 {
-	if (NULL == put || put == pev->pCUNILOG_TARGET)
-	{
-		if (pev->szDataToLog && cunilogIsEventDataAllocated (pev))
+	ubf_assert_non_NULL (put);
+
+	if (0 == put->lnCoutBuf)
+		return true;
+
+	// Anything written to stdout with the C library before, like control codes, goes first.
+	fflush (stdout);
+	bool bRet = cunilogWriteToStdout (put->mbCoutBuf.buf.pcc, put->lnCoutBuf);
+	put->lnCoutBuf = 0;
+	return bRet;
+}
+
+/*
+	Writes lnData octets of pData to stdout, bypassing the C library. Returns false if
+	this fails.
+*/
+static bool cunilogWriteToStdout (const char *pData, size_t lnData)
+{
+	ubf_assert_non_NULL (pData);
+
+	bool bRet = true;
+	#ifdef PLATFORM_IS_WINDOWS
+		HANDLE	hOut	= GetStdHandle (STD_OUTPUT_HANDLE);
+		DWORD	dwWritten;
+		while (lnData)
 		{
-			ubf_free ((char *) pev->szDataToLog);
+			DWORD toWrite = lnData > 0x7FFFFFFF ? 0x7FFFFFFF : (DWORD) lnData;
+			if (!WriteFile (hOut, pData, toWrite, &dwWritten, NULL) || 0 == dwWritten)
+			{
+				bRet = false;
+				break;
+			}
+			pData	+= dwWritten;
+			lnData	-= dwWritten;
 		}
-		if (cunilogIsEventAllocated (pev))
+	#else
+		while (lnData)
 		{
-			ubf_free (pev);
+			ssize_t written = write (STDOUT_FILENO, pData, lnData);
+			if (written < 0 && EINTR == errno)
+				continue;
+			if (written <= 0)
+			{
+				bRet = false;
+				break;
+			}
+			pData	+= written;
+			lnData	-= (size_t) written;
 		}
+	#endif
+	return bRet;
+}
+
+/*
+	Adds the nfr fragments pfr points to plus a line ending to the console output buffer
+	and writes the buffer to stdout when the batch is complete.
+*/
+static bool cunilogAddToCoutBuffer (CUNILOG_TARGET *put, const CUNILOG_FRAGMENT *pfr, unsigned int nfr)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (pfr);
+
+	size_t			lnAdd	= CUNILOG_COUT_NEWLINE_LEN;
+	bool			bRet	= true;
+	unsigned int	n;
+
+	for (n = 0; n < nfr; ++ n)
+		lnAdd += pfr [n].len;
+
+	if (put->lnCoutBuf && put->lnCoutBuf + lnAdd > CUNILOG_COUT_BUFFER_SIZE)
+		bRet = cunilogFlushCoutBuffer (put);
+	size_t	lnReq	= put->lnCoutBuf + lnAdd;
+	if (!growToSizeSMEMBUF (&put->mbCoutBuf, lnReq > CUNILOG_COUT_BUFFER_SIZE ? lnReq : CUNILOG_COUT_BUFFER_SIZE))
+		return false;
+
+	if (0 == put->lnCoutBuf)
+		put->uiCoutBatchStart = GetSystemTimeAsULONGLONGrel ();
+	for (n = 0; n < nfr; ++ n)
+	{
+		memcpy (put->mbCoutBuf.buf.pch + put->lnCoutBuf, pfr [n].ccText, pfr [n].len);
+		put->lnCoutBuf += pfr [n].len;
 	}
-	return NULL;
+	memcpy (put->mbCoutBuf.buf.pch + put->lnCoutBuf, CUNILOG_COUT_NEWLINE, CUNILOG_COUT_NEWLINE_LEN);
+	put->lnCoutBuf += CUNILOG_COUT_NEWLINE_LEN;
+
+	// FILETIME ticks are 100 ns.
+	if	(
+				put->lnCoutBuf >= CUNILOG_COUT_BUFFER_SIZE
+			||		GetSystemTimeAsULONGLONGrel () - put->uiCoutBatchStart
+				>=	(uint64_t) CUNILOG_COUT_FLUSH_INTERVAL_MS * 10000
+		)
+		bRet &= cunilogFlushCoutBuffer (put);
+	return bRet;
 }
 
+/*
+	The asynchronous console output stage. See OPT_CUNPROC_ASYNC and CUNILOG_COUT_ASYNC.
+*/
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put);
-#endif
+	static inline void lockCoutAsync (CUNILOG_COUT_ASYNC *pca)
+	{
+		#ifdef OS_IS_WINDOWS
+			EnterCriticalSection (&pca->cl.cs);
+		#else
+			pthread_mutex_lock (&pca->cl.mt);
+		#endif
+	}
 
-#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
-	void cunilogSetTargetErrorAndInvokeErrorCallback	(
-			CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
-														)
+	static inline void unlockCoutAsync (CUNILOG_COUT_ASYNC *pca)
 	{
-		ubf_assert_non_NULL (cup);
-		ubf_assert_non_NULL (pev);
-		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+		#ifdef OS_IS_WINDOWS
+			LeaveCriticalSection (&pca->cl.cs);
+		#else
+			pthread_mutex_unlock (&pca->cl.mt);
+		#endif
+	}
 
-		#ifdef PLATFORM_IS_WINDOWS
-			DWORD syserror = GetLastError ();
+	static inline void triggerCoutAsync (CUNILOG_COUT_ASYNC *pca)
+	{
+		#ifdef OS_IS_WINDOWS
+			ReleaseSemaphore (pca->sm.hSemaphore, 1, NULL);
 		#else
-			int32_t syserror = errno;
+			sem_post (&pca->sm.tSemaphore);
 		#endif
-		SetCunilogError (pev->pCUNILOG_TARGET, cunilog_error, syserror);
+	}
 
-		if (pev->pCUNILOG_TARGET->errorCB)
+	static inline bool waitForCoutAsync (CUNILOG_COUT_ASYNC *pca)
+	{
+		#ifdef OS_IS_WINDOWS
+			return WAIT_OBJECT_0 == WaitForSingleObject (pca->sm.hSemaphore, INFINITE);
+		#else
+			int i;
+			do
+				i = sem_wait (&pca->sm.tSemaphore);
+			while (0 != i && EINTR == errno);
+			return 0 == i;
+		#endif
+	}
+
+	/*
+		The thread of the stage. It swaps the pending buffer with its own one and writes
+		it to stdout outside the lock, which means that appending to the pending buffer
+		never waits for stdout.
+	*/
+	static SEPARATE_LOGGING_THREAD_RETURN_TYPE CoutAsyncThread (CUNILOG_COUT_ASYNC *pca)
+	{
+		ubf_assert_non_NULL (pca);
+
+		while (waitForCoutAsync (pca))
 		{
-			errCBretval rv = pev->pCUNILOG_TARGET->errorCB (pev->pCUNILOG_TARGET->error, cup, pev);
-			ubf_assert (0 <= rv);
-			ubf_assert (cunilogErrCB_AmountEnumValues > rv);
+			lockCoutAsync (pca);
+			char		*pch		= pca->pchPending;
+			size_t		ln			= pca->lnPending;
+			uint64_t	nDropped	= pca->nDropped;
+			bool		bShutdown	= pca->bShutdown;
+			pca->pchPending	= pca->pchWriting;
+			pca->pchWriting	= pch;
+			pca->lnPending	= 0;
+			pca->nDropped	= 0;
+			unlockCoutAsync (pca);
+
+			if (ln)
+				cunilogWriteToStdout (pch, ln);
+			if (nDropped)
+			{
+				char	sz [CUNILOG_STD_MSG_SIZE];
+				int		len = snprintf	(
+								sz, CUNILOG_STD_MSG_SIZE,
+								"%" PRIu64 " console line(s) dropped." CUNILOG_COUT_NEWLINE,
+								nDropped
+										);
+				if (0 < len)
+					cunilogWriteToStdout (sz, (size_t) len);
+			}
+			if (bShutdown)
+				break;
+		}
+		return SEPARATE_LOGGING_THREAD_RETURN_SUCCESS;
+	}
 
-			#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-				CUNILOG_EVENT *pve;
-				CUNILOG_EVENT *nxt;
-			#endif
+	/*
+		Returns the asynchronous stage of the target put points to. The stage is created
+		and its thread started when it's needed for the first time. Returns NULL if this
+		fails.
+	*/
+	static CUNILOG_COUT_ASYNC *cunilogCoutAsync (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
 
-			switch (rv)
+		if (put->pcas)
+			return put->pcas;
+
+		size_t				aln	= ALIGNED_SIZE (sizeof (CUNILOG_COUT_ASYNC), CUNILOG_DEFAULT_ALIGNMENT);
+		CUNILOG_COUT_ASYNC	*pca	= ubf_malloc (aln + 2 * (size_t) CUNILOG_COUT_ASYNC_SIZE);
+		if (NULL == pca)
+			return NULL;
+		pca->pchPending	= (char *) pca + aln;
+		pca->pchWriting	= pca->pchPending + CUNILOG_COUT_ASYNC_SIZE;
+		pca->lnPending	= 0;
+		pca->nDropped	= 0;
+		pca->bShutdown	= false;
+
+		#ifdef OS_IS_WINDOWS
+			pca->sm.hSemaphore = CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
+			if (NULL == pca->sm.hSemaphore)
 			{
-				case cunilogErrCB_ignore:
-					break;
-				case cunilogErrCB_next_processor:
-					break;
-				case cunilogErrCB_next_event:
-					cunilogEventSetIgnoreRemainingProcessors (pev);
-					break;
-				case cunilogErrCB_shutdown:
-					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
-					break;
-				case cunilogErrCB_cancel:
-					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
-					#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-						pve = DequeueAllCUNILOG_EVENTs (pev->pCUNILOG_TARGET);
-						while (pve)
-						{
-							nxt = pve->next;
-							DoneCUNILOG_EVENT (NULL, pve);
-							pve = nxt;
-						}
-					#endif
-					break;
-				default:
-					ubf_assert (false);
-					break;
+				ubf_free (pca);
+				return NULL;
+			}
+			InitializeCriticalSection (&pca->cl.cs);
+			pca->th.hThread = CreateThread	(
+								NULL, 0, (LPTHREAD_START_ROUTINE) CoutAsyncThread, pca, 0, NULL
+											);
+			if (NULL == pca->th.hThread)
+			{
+				DeleteCriticalSection (&pca->cl.cs);
+				CloseHandle (pca->sm.hSemaphore);
+				ubf_free (pca);
+				return NULL;
+			}
+		#else
+			if (0 != sem_init (&pca->sm.tSemaphore, 0, 0))
+			{
+				ubf_free (pca);
+				return NULL;
+			}
+			pthread_mutex_init (&pca->cl.mt, NULL);
+			if	(
+					0 != pthread_create	(
+							&pca->th.tThread, NULL,
+							(void * (*)(void *)) CoutAsyncThread, pca
+										)
+				)
+			{
+				pthread_mutex_destroy (&pca->cl.mt);
+				sem_destroy (&pca->sm.tSemaphore);
+				ubf_free (pca);
+				return NULL;
 			}
+		#endif
+		put->pcas = pca;
+		return pca;
+	}
+
+	/*
+		Returns the asynchronous stage for the processor cup points to, or NULL if the
+		processor doesn't have the option flag OPT_CUNPROC_ASYNC. If the stage cannot be
+		created, the flag is cleared and the processor outputs synchronously from then on.
+	*/
+	static inline CUNILOG_COUT_ASYNC *cunilogCoutAsyncForProcessor	(
+											CUNILOG_PROCESSOR	*cup,
+											CUNILOG_TARGET		*put
+																	)
+	{
+		ubf_assert_non_NULL (cup);
+		ubf_assert_non_NULL (put);
+
+		if (!optCunProcHasOPT_CUNPROC_ASYNC (cup->uiOpts))
+			return NULL;
+		CUNILOG_COUT_ASYNC *pca = cunilogCoutAsync (put);
+		if (NULL == pca)
+			optCunProcClrOPT_CUNPROC_ASYNC (cup->uiOpts);
+		return pca;
+	}
+
+	/*
+		Appends the nfr fragments pfr points to, followed by a line ending if bNewLine is
+		true, to the pending buffer of the stage. The output is dropped if it doesn't fit.
+	*/
+	static void cunilogAddToCoutAsync	(
+					CUNILOG_COUT_ASYNC		*pca,
+					const CUNILOG_FRAGMENT	*pfr,
+					unsigned int			nfr,
+					bool					bNewLine
+										)
+	{
+		ubf_assert_non_NULL (pca);
+		ubf_assert_non_NULL (pfr);
+
+		size_t			lnAdd	= bNewLine ? CUNILOG_COUT_NEWLINE_LEN : 0;
+		unsigned int	n;
+		for (n = 0; n < nfr; ++ n)
+			lnAdd += pfr [n].len;
+
+		lockCoutAsync (pca);
+		if (pca->lnPending + lnAdd > CUNILOG_COUT_ASYNC_SIZE)
+		{
+			++ pca->nDropped;
+			unlockCoutAsync (pca);
+			return;
+		}
+		// The thread only needs to be woken up when the buffer was empty.
+		bool	bTrigger	= 0 == pca->lnPending;
+		char	*sz			= pca->pchPending + pca->lnPending;
+		for (n = 0; n < nfr; ++ n)
+		{
+			memcpy (sz, pfr [n].ccText, pfr [n].len);
+			sz += pfr [n].len;
 		}
+		if (bNewLine)
+			memcpy (sz, CUNILOG_COUT_NEWLINE, CUNILOG_COUT_NEWLINE_LEN);
+		pca->lnPending += lnAdd;
+		unlockCoutAsync (pca);
+		if (bTrigger)
+			triggerCoutAsync (pca);
 	}
 
 	/*
-		cunilogTestErrorCB
+		Writes the remaining output of the stage, ends its thread, and destroys it.
 	*/
-	#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
-		void cunilogTestErrorCB	(
-				CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
-								)
-		{
-			ubf_assert_non_NULL (cup);
-			ubf_assert_non_NULL (pev);
-			ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	static void cunilogDoneCoutAsync (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
 
-			if (cunilogTargetHasAlwaysCallErrorCB (pev->pCUNILOG_TARGET))
-			{
-				errCBretval rv = pev->pCUNILOG_TARGET->errorCB	(
-										cunilog_error, cup, pev
-																);
-				UNUSED (rv);
-				ubf_assert (0 <= rv);
-				ubf_assert (cunilogErrCB_AmountEnumValues > rv);
-			}
-		}
-	#else
-		#define cunilogTestErrorCB(error, cup, pev)
-	#endif
-#else
-	#define cunilogInvokeErrorCallback(error, cup, pev)
-	#define cunilogTestErrorCB(error, cup, pev)
+		CUNILOG_COUT_ASYNC *pca = put->pcas;
+		if (NULL == pca)
+			return;
+
+		lockCoutAsync (pca);
+		pca->bShutdown = true;
+		unlockCoutAsync (pca);
+		triggerCoutAsync (pca);
+
+		#ifdef OS_IS_WINDOWS
+			WaitForSingleObject (pca->th.hThread, INFINITE);
+			CloseHandle (pca->th.hThread);
+			DeleteCriticalSection (&pca->cl.cs);
+			CloseHandle (pca->sm.hSemaphore);
+		#else
+			pthread_join (pca->th.tThread, NULL);
+			pthread_mutex_destroy (&pca->cl.mt);
+			sem_destroy (&pca->sm.tSemaphore);
+		#endif
+		ubf_free (pca);
+		put->pcas = NULL;
+	}
 #endif
 
 /*
-	The dummy/no-operation processor.
+	Writes the nfr fragments pfr points to plus a line ending to stdout without copying
+	them. Returns EOF on error.
 */
-static bool cunilogProcessNoneFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	UNREFERENCED_PARAMETER (cup);
-	UNREFERENCED_PARAMETER (pev);
-
-	return true;
-}
-
 #ifdef PLATFORM_IS_WINDOWS
-	static inline int cunilogPutsWin (const char *szOutput, size_t len)
+	static int cunilogPutsFragmentsWin (const CUNILOG_FRAGMENT *pfr, unsigned int nfr)
 	{
+		ubf_assert_non_NULL (pfr);
+
 		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
 			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
 		CunilogEnableANSIifNotInitialised ();
 
-		if (len)
-		{	// These functions expect a NUL-terminated string.
-			ubf_assert (strlen (szOutput) == len);
-			ubf_assert (ASCII_NUL == szOutput [len]);
-
-			switch (ourCunilogConsoleOutputCodePage)
-			{
-				case cunilogConsoleIsUTF8:		return puts					(szOutput);
-				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	(szOutput);
-				case cunilogConsoleIsNeither:	return puts					(szOutput);
-				default:						return puts					(szOutput);
-			}
-		} else
+		unsigned int n;
+		for (n = 0; n < nfr; ++ n)
 		{
-			switch (ourCunilogConsoleOutputCodePage)
+			if (0 == pfr [n].len)
+				continue;
+			ubf_assert (pfr [n].len <= INT_MAX);
+			if (cunilogConsoleIsUTF16 == ourCunilogConsoleOutputCodePage)
 			{
-				case cunilogConsoleIsUTF8:		return puts					("");
-				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	("");
-				case cunilogConsoleIsNeither:	return puts					("");
-				default:						return puts					("");
-			}
+				int iLen = pfr [n].len & INT_MAX;
+				if (0 > fprintfU8toU16stream (stdout, "%.*s", iLen, pfr [n].ccText))
+					return EOF;
+			} else
+			if (pfr [n].len != fwrite (pfr [n].ccText, 1, pfr [n].len, stdout))
+				return EOF;
 		}
+		return cunilogConsoleIsUTF16 == ourCunilogConsoleOutputCodePage
+				? putsU8toU16stdout ("")
+				: puts ("");
 	}
-#endif
-
-#ifdef PLATFORM_IS_WINDOWS
-	static inline int cunilogPrintWin (const char *szOutput, size_t len)
+#else
+	static int cunilogPutsFragmentsPsx (const CUNILOG_FRAGMENT *pfr, unsigned int nfr)
 	{
-		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
-			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
-		CunilogEnableANSIifNotInitialised ();
+		ubf_assert_non_NULL (pfr);
+		ubf_assert			(nfr < cunilogCoutFragXAmountEnumValues + 1);
 
-		if (len)
-		{	// These functions expect a NUL-terminated string.
-			ubf_assert (strlen (szOutput) == len);
-			ubf_assert (ASCII_NUL == szOutput [len]);
+		struct iovec	iov [cunilogCoutFragXAmountEnumValues + 1];
+		int				niov	= 0;
+		size_t			lnTotal	= 0;
+		unsigned int	n;
 
-			switch (ourCunilogConsoleOutputCodePage)
-			{
-				case cunilogConsoleIsUTF8:		return printf				(szOutput);
-				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, szOutput);
-				case cunilogConsoleIsNeither:	return printf				(szOutput);
-				default:						return printf				(szOutput);
-			}
-		} else
+		for (n = 0; n < nfr; ++ n)
 		{
-			switch (ourCunilogConsoleOutputCodePage)
+			if (pfr [n].len)
 			{
-				case cunilogConsoleIsUTF8:		return printf				("");
-				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, "");
-				case cunilogConsoleIsNeither:	return printf				("");
-				default:						return printf				("");
+				iov [niov].iov_base	= (void *) pfr [n].ccText;
+				iov [niov].iov_len	= pfr [n].len;
+				lnTotal += pfr [n].len;
+				++ niov;
 			}
 		}
-	}
-#endif
-
-#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-	static inline void cunilogFillColouredCoutEvtLine	(
-							char				**pszToOutput,
-							size_t				*plnToOutput,
-							CUNILOG_EVENT		*pev
-														)
-	{
-		ubf_assert_non_NULL (pszToOutput);
-		ubf_assert_non_NULL (plnToOutput);
-		ubf_assert_non_NULL (pev);
-
-		// Includes LEN_ANSI_RESET too.
-		size_t	lnThisColour	= evtSeverityColoursLen (pev->evSeverity);
-
-		if	(
-					cunilogTargetHasUseColourForCout (pev->pCUNILOG_TARGET)
-				&&	lnThisColour
-			)
+		iov [niov].iov_base	= (void *) CUNILOG_COUT_NEWLINE;
+		iov [niov].iov_len	= CUNILOG_COUT_NEWLINE_LEN;
+		lnTotal += CUNILOG_COUT_NEWLINE_LEN;
+		++ niov;
+
+		// Anything written to stdout with the C library before goes first.
+		fflush (stdout);
+		ssize_t written;
+		do
+			written = writev (STDOUT_FILENO, iov, niov);
+		while (written < 0 && EINTR == errno);
+		if (written < 0)
+			return EOF;
+
+		// Partial writes. Rare enough to write the remainder fragment by fragment.
+		int i = 0;
+		while ((size_t) written < lnTotal)
 		{
-			size_t	lnEvtLine		= pev->pCUNILOG_TARGET->lnLogEventLine;
-			size_t	lnColEcho		= lnThisColour
-									+ lnEvtLine
-									;
-
-			growToSizeSMEMBUF (&pev->pCUNILOG_TARGET->mbColEventLine, lnColEcho + 1);
-			if (isUsableSMEMBUF (&pev->pCUNILOG_TARGET->mbColEventLine))
+			while ((size_t) written >= iov [i].iov_len)
 			{
-				ubf_assert	(
-									strlen (pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch)
-								==	pev->pCUNILOG_TARGET->lnLogEventLine
-							);
-				char *sz = pev->pCUNILOG_TARGET->mbColEventLine.buf.pch;
-				cpyEvtSeverityColour (&sz, pev->evSeverity);
-				memcpy (sz, pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch, lnEvtLine);
-				sz += lnEvtLine;
-				cpyRstEvtSeverityColour (&sz, pev->evSeverity);
-				*sz = ASCII_NUL;
-				pev->pCUNILOG_TARGET->lnColEventLine = lnColEcho;
-				*pszToOutput = pev->pCUNILOG_TARGET->mbColEventLine.buf.pch;
-				*plnToOutput = lnColEcho;
-				return;
+				written	-= iov [i].iov_len;
+				lnTotal	-= iov [i].iov_len;
+				++ i;
 			}
+			ssize_t w = write	(
+							STDOUT_FILENO,
+							(const char *) iov [i].iov_base + written,
+							iov [i].iov_len - written
+								);
+			if (w < 0 && EINTR == errno)
+				continue;
+			if (w <= 0)
+				return EOF;
+			written += w;
 		}
-		*pszToOutput = pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
-		*plnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
+		return 0;
 	}
 #endif
 
@@ -4048,7 +6220,7 @@ static bool cunilogProcessControlCodeCoutFnct	(
 
 static bool cunilogProcessCoutFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
-	UNREFERENCED_PARAMETER (cup);
+	ubf_assert_non_NULL (cup);
 	ubf_assert_non_NULL (pev);
 	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
 
@@ -4062,28 +6234,73 @@ static bool cunilogProcessCoutFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 	//		- The length of the event line has been stored correctly.
 	//		- If we require a lock, we have it already.
 
-	char	*szToOutput;
-	size_t	lnToOutput;
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
 
-	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-		cunilogFillColouredCoutEvtLine (&szToOutput, &lnToOutput, pev);
-	#else
-		szToOutput = pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
-		lnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CUNILOG_COUT_ASYNC	*pca	= cunilogCoutAsyncForProcessor (cup, put);
 	#endif
 
 	if (cunilogEvtTypeControlCode == pev->evType)
-		return cunilogProcessControlCodeCoutFnct (szToOutput, lnToOutput, cup, pev);
+	{	// Keeps the order of the output. Control codes are not coloured.
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			if (pca)
+			{
+				CUNILOG_FRAGMENT fr;
+				fr.ccText	= put->mbLogEventLine.buf.pcc;
+				fr.len		= put->lnLogEventLine;
+				cunilogAddToCoutAsync (pca, &fr, 1, false);
+				return true;
+			}
+		#endif
+		cunilogFlushCoutBuffer (put);
+		return cunilogProcessControlCodeCoutFnct	(
+					put->mbLogEventLine.buf.pch, put->lnLogEventLine, cup, pev
+													);
+	}
+
+	CUNILOG_FRAGMENT	afr [cunilogCoutFragXAmountEnumValues];
+
+	if (optCunProcHasOPT_CUNPROC_JSON (cup->uiOpts))
+	{
+		if (CUNILOG_SIZE_ERROR == cunilogJSONLineFromEvent (pev))
+		{
+			cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_HEAP_ALLOCATION, cup, pev);
+			return false;
+		}
+		// No colours for JSON.
+		cunilogFillCoutFragments (afr, put->mbJSONLine.buf.pch, put->lnJSONLine, pev);
+		afr [cunilogCoutFragColour].len	= 0;
+		afr [cunilogCoutFragReset].len	= 0;
+	} else
+		cunilogFillCoutFragments (afr, put->mbLogEventLine.buf.pch, put->lnLogEventLine, pev);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pca)
+		{	// Never waits for stdout. The stage batches by itself.
+			cunilogAddToCoutAsync (pca, afr, cunilogCoutFragXAmountEnumValues, true);
+			return true;
+		}
+	#endif
+
+	if (cunilogHasCoutBuffered (put))
+	{
+		if (!cunilogAddToCoutBuffer (put, afr, cunilogCoutFragXAmountEnumValues))
+		{	// "Bad file descriptor" might not be the best error here but what's better?
+			cunilogSetTargetErrorAndInvokeErrorCallback (EBADF, cup, pev);
+			return false;
+		}
+		return true;
+	}
 
 	int		ips;
 
 	#ifdef PLATFORM_IS_WINDOWS
-		ips = cunilogPutsWin (szToOutput, lnToOutput);
-	#else
-		if (lnToOutput)
-			ips = puts (szToOutput);
+		if (afr [cunilogCoutFragColour].len)
+			ips = cunilogPutsFragmentsWin (afr, cunilogCoutFragXAmountEnumValues);
 		else
-			ips = puts ("");
+			ips = cunilogPutsWin (afr [cunilogCoutFragLine].ccText, afr [cunilogCoutFragLine].len);
+	#else
+		ips = cunilogPutsFragmentsPsx (afr, cunilogCoutFragXAmountEnumValues);
 	#endif
 
 	if (EOF == ips)
@@ -4121,7 +6338,7 @@ static bool cunilogProcessUpdateLogFileNameFnct (CUNILOG_PROCESSOR *cup, CUNILOG
 		case cunilogPostfixWeek:
 		case cunilogPostfixMonth:
 		case cunilogPostfixYear:
-			savePrevTimestamp (pev);
+			updatePostfixPeriod (pev);
 			return true;
 
 		case cunilogPostfixLogMinute:
@@ -4165,6 +6382,54 @@ static inline bool cunilogOpenNewLogFile (CUNILOG_TARGET *put)
 	#endif
 }
 
+/*
+	Adds the logfile that has just been created to the files list. A new logfile is always
+	the most recent one, which is at the end of the list, or at its beginning if the list
+	is reversed. If the list hasn't been obtained yet, there's nothing to do as it is going
+	to be read from disk anyway.
+*/
+static void cunilogAddNewLogfileToFLS (CUNILOG_TARGET *put, uint64_t uiPrevSize)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (!hasDotNumberPostfix (put));
+	ubf_assert (!hasLogPostfix (put));
+
+	if (0 == put->fls.length)
+		return;
+
+	CUNILOG_FLS	fls;
+	const char	*szName	= put->mbLogfileName.buf.pcc + put->lnLogPath;
+	fls.stFilename		= strlen (szName) + 1;
+	fls.uiSize			= 0;
+
+	size_t		idx		= cunilogTargetHasFLSreversed (put) ? 0 : put->fls.length - 1;
+	if	(
+				fls.stFilename == put->fls.data [idx].stFilename
+			&&	!memcmp (szName, put->fls.data [idx].chFilename, fls.stFilename)
+		)
+		return;
+
+	// The most recent file so far is the previous logfile, which doesn't grow anymore.
+	put->fls.data [idx].uiSize = uiPrevSize;
+
+	fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
+	if (fls.chFilename)
+	{
+		memcpy ((char *) fls.chFilename, szName, fls.stFilename);
+		if (cunilogTargetHasFLSreversed (put))
+		{
+			if (0 == vec_insert (&put->fls, 0, fls))
+				return;
+		} else
+		{
+			if (0 == vec_push (&put->fls, fls))
+				return;
+		}
+	}
+	SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+	cunilogResetFilesList (put);
+}
+
 static inline bool requiresOpenLogFile (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
@@ -4217,23 +6482,28 @@ static inline size_t addNewLineToLogEventLine (char *pData, size_t lnData, newli
 	return lnData + len;
 }
 
-static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+/*
+	Writes the event line, or the JSON line if bJSON is true, to the logfile.
+*/
+static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put, CUNILOG_EVENT *pev, bool bJSON)
 {
 	ubf_assert_non_NULL	(put);
 	ubf_assert			(cunilogIsTargetInitialised (put));
 	ubf_assert_non_NULL	(pev);
+	ubf_assert			(!bJSON || pev == put->pevJSONLine);
 
-	char		*pData	= put->mbLogEventLine.buf.pch;
-	size_t		lnData	= put->lnLogEventLine;
+	SMEMBUF		*pmb	= bJSON ? &put->mbJSONLine	: &put->mbLogEventLine;
+	char		*pData	= pmb->buf.pch;
+	size_t		lnData	= bJSON ? put->lnJSONLine	: put->lnLogEventLine;
 	newline_t	nl		= put->culogNewLine;
 
 	// We need space for the line ending plus a NUL character.
-	ubf_assert (put->mbLogEventLine.size > put->lnLogEventLine + lnLineEnding (nl));
+	ubf_assert (pmb->size > lnData + lnLineEnding (nl));
 
 	#ifdef OS_IS_WINDOWS
 		DWORD dwWritten;
 		DWORD toWrite	= (cunilogEvtTypeControlCode == pev->evType)
-						? put->lnLogEventLine & 0xFFFFFFFF
+						? lnData & 0xFFFFFFFF
 						: addNewLineToLogEventLine (pData, lnData, nl) & 0xFFFFFFFF;
 		// The file has been opened with FILE_APPEND_DATA, i.e. we don't need to
 		//	seek ourselves.
@@ -4241,10 +6511,11 @@ static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 		//	SetFilePointerEx (pl->hLogFile, z, NULL, FILE_END);
 		bool b = WriteFile (put->logfile.hLogFile, pData, toWrite, &dwWritten, NULL);
 		pData [lnData] = ASCII_NUL;
+		put->uiLogfileSize += dwWritten;
 		return b;
 	#else
 		size_t toWrite	= (cunilogEvtTypeControlCode == pev->evType)
-						? put->lnLogEventLine & 0xFFFFFFFF;
+						? lnData
 						: addNewLineToLogEventLine (pData, lnData, nl);
 		// See https://www.man7.org/linux/man-pages/man3/fopen.3.html .
 		//	A call "fseek (pl->fLogFile, (long) 0, SEEK_END);" is not required
@@ -4252,7 +6523,9 @@ static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 		//size_t st = fwrite (pData, 1, ToWrite, put->logfile.fLogFile);
 		ssize_t written = write (put->logfile.fd, pData, toWrite);
 		pData [lnData] = ASCII_NUL;
-		return st == lnData;
+		if (written > 0)
+			put->uiLogfileSize += (uint64_t) written;
+		return written == (ssize_t) toWrite;
 	#endif
 }
 
@@ -4282,10 +6555,22 @@ static bool cunilogProcessWriteToLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EV
 		} else
 		if (REQUIRES_NEW_LOGFILE (put, cup, pev))
 		{
-			if (!cunilogOpenNewLogFile (put))
+			uint64_t uiPrevSize = put->uiLogfileSize;
+			if (cunilogOpenNewLogFile (put))
+			{
+				cunilogAddNewLogfileToFLS (put, uiPrevSize);
+				cunilogFilesListInSync (put);
+			} else
 				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
 		}
-		if (!cunilogWriteDataToLogFile (put, pev))
+		bool bJSON	=		optCunProcHasOPT_CUNPROC_JSON (cup->uiOpts)
+						&&	cunilogEvtTypeControlCode != pev->evType;
+		if (bJSON && CUNILOG_SIZE_ERROR == cunilogJSONLineFromEvent (pev))
+		{
+			cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_HEAP_ALLOCATION, cup, pev);
+			return true;
+		}
+		if (!cunilogWriteDataToLogFile (put, pev, bJSON))
 				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_WRITING_LOGFILE, cup, pev);
 	}
 	return true;
@@ -4461,6 +6746,86 @@ static inline size_t incrementDotNumberName (char *sz)
 	}
 }
 
+/*
+	Writes the dot number part ".<ui>" after the 'g' of ".log" sz points to.
+
+	Returns the length of the dot number part, including the dot.
+*/
+static inline size_t writeDotNumberName (char *sz, uint64_t ui)
+{
+	ubf_assert_non_NULL	(sz);
+	ubf_assert			('g' == sz [0]);
+
+	++ sz;
+	sz [0] = '.';
+	++ sz;
+	size_t written = ubf_str_from_uint64 (sz, ui);
+	++ written;												// The '.'
+	return written;
+}
+
+/*
+	Obtains the number of the dot number part of a files list entry, i.e. 900 for
+	"file.log.900". Returns false if the entry has no dot number part, which is the
+	case for the active logfile "file.log".
+*/
+static inline bool dotNumberFromFLS (uint64_t *pui, const CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL	(pui);
+	ubf_assert_non_NULL	(pfls);
+	ubf_assert_non_NULL	(pfls->chFilename);
+	ubf_assert_non_0	(pfls->stFilename);
+
+	size_t o = pfls->stFilename - 1;						// Index of the NUL terminator.
+	size_t d = o;
+	while (o && isdigit (pfls->chFilename [o - 1]))
+		-- o;
+	if (o == d || 0 == o || '.' != pfls->chFilename [o - 1])
+		return false;
+	ubf_uint64_from_str (pui, pfls->chFilename + o);
+	return true;
+}
+
+/*
+	Records the dot number of a compressed logfile "<app>.log.<n>.<ext>", for instance
+	"<app>.log.900.gz". These files are not part of the files list but their numbers
+	must not be used again. szName is a name the search mask "<app>.log*" matches.
+*/
+static void recordArchivedDotNumber (CUNILOG_TARGET *put, const char *szName, size_t lnName)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (szName);
+
+	size_t o = put->lnAppName + lenCunilogLogFileNameExtension;
+	if (o + 1 >= lnName || '.' != szName [o])
+		return;
+	++ o;
+	uint64_t	ui;
+	size_t		ln = ubf_uint64_from_str_n (&ui, szName + o, lnName - o, enUintFromStrDontAllowPlus);
+	if (ln && o + ln < lnName && '.' == szName [o + ln] && ui > put->uiArchivedDotNumber)
+		put->uiArchivedDotNumber = ui;
+}
+
+/*
+	Returns the highest dot number in the files list, or 0 if there's none. Compressed
+	logfiles are included. See recordArchivedDotNumber ().
+*/
+static inline uint64_t highestDotNumberInFLS (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	uint64_t	uiHighest	= put->uiArchivedDotNumber;
+	uint64_t	ui;
+	size_t		n			= put->fls.length;
+
+	while (n --)
+	{
+		if (dotNumberFromFLS (&ui, &put->fls.data [n]) && ui > uiHighest)
+			uiHighest = ui;
+	}
+	return uiHighest;
+}
+
 static inline char *findDotNumberPart (size_t *pln, CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (pln);
@@ -4578,6 +6943,7 @@ static inline void cunilogAddActiveLogfile (bool bIsActiveLogfile, bool i, CUNIL
 	if (bIsActiveLogfile)
 	{
 		CUNILOG_FLS	currFls;
+		currFls.uiSize		= 0;							// See uiLogfileSize.
 		currFls.stFilename = put->lnAppName + sizCunilogLogFileNameExtension;
 		currFls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, currFls.stFilename);
 		if (currFls.chFilename)
@@ -4621,8 +6987,14 @@ static inline bool prepareDotNumberPostfixFileToRename	(
 	// Either ".log.<number>" orr "g" from ".log".
 	ubf_assert ('.' == sz [0] || 'g' == sz [0]);
 	bIsActiveLogfile = 'g' == sz [0];
-	*poldLength = put->lnFilToRotate - ln;
-	*pnewLength = incrementDotNumberName (sz);
+	// The active logfile has no dot number part yet.
+	*poldLength = bIsActiveLogfile ? 0 : put->lnFilToRotate - ln;
+	if (cunilogHasDotNumberMonotonic (put))
+	{	// Only the active logfile is ever renamed in monotonic mode.
+		ubf_assert (bIsActiveLogfile);
+		*pnewLength = writeDotNumberName (sz, highestDotNumberInFLS (put) + 1);
+	} else
+		*pnewLength = incrementDotNumberName (sz);
 	return bIsActiveLogfile;
 }
 
@@ -4717,42 +7089,55 @@ static void cunilogRenameLogfile (CUNILOG_TARGET *put)
 			return;
 		}
 
-		bool bMoved;
+		bool		bMoved;
+		uint64_t	uiActiveSize	= put->uiLogfileSize;	// Reset when re-opened.
 
+		if (bIsActiveLogfile)
+			cunilogCloseCUNILOG_LOGFILEifOpen (put);
 		#ifdef PLATFORM_IS_WINDOWS
-			if (bIsActiveLogfile)
-				cunilogCloseCUNILOG_LOGFILEifOpen (put);
 			bMoved = MoveFileU8long (put->mbFilToRotate.buf.pch, prd->mbDstFile.buf.pcc);
-			if (bIsActiveLogfile && requiresOpenLogFile (put))
+		#else
+			bMoved = 0 == cunilogRenameInLogFold	(
+								put, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
+													);
+		#endif
+		if (bIsActiveLogfile && requiresOpenLogFile (put))
+		{
+			if (!cunilogOpenLogFile (put))
 			{
-				if (!cunilogOpenLogFile (put))
-				{
-					SetCunilogSystemError (put, CUNILOG_ERROR_OPENING_LOGFILE);
-					cunilogSetTargetErrorAndInvokeErrorCallback	(
-						CUNILOG_ERROR_OPENING_LOGFILE,
-						put->prargs->cup, put->prargs->pev
-																);
-				}
+				SetCunilogSystemError (put, CUNILOG_ERROR_OPENING_LOGFILE);
+				cunilogSetTargetErrorAndInvokeErrorCallback	(
+					CUNILOG_ERROR_OPENING_LOGFILE,
+					put->prargs->cup, put->prargs->pev
+															);
 			}
-			if (bMoved)
+		}
+		if (bMoved)
+		{
+			// The renamed file is no longer the current logfile and keeps its last size.
+			if (bIsActiveLogfile)
+				put->fls.data [put->prargs->idx].uiSize = uiActiveSize;
+			if (hasDotNumberPostfix (put))
 			{
-				if (hasDotNumberPostfix (put))
-				{
-					renameDotNumberPostfixInFLS (put, newLen, oldLen);
-					cunilogAddActiveLogfile (bIsActiveLogfile, false, put);
-				} else
-				if (hasLogPostfix (put))
-				{
-					renameLogPostfixInFLS (put, szNewFileName, newLen);
-					cunilogAddActiveLogfile (bIsActiveLogfile, true, put);
-				}
-				logFromInsideRotatorTextU8fmt	(
-					put, "File \"%s\" moved/renamed to \"%s\".",
-					put->mbFilToRotate.buf.pcc,
-					prd->mbDstFile.buf.pcc
-												);
+				renameDotNumberPostfixInFLS (put, newLen, oldLen);
+				// In monotonic mode the list is reversed for this rotator too.
+				cunilogAddActiveLogfile	(
+					bIsActiveLogfile, cunilogHasDotNumberMonotonic (put), put
+										);
 			} else
+			if (hasLogPostfix (put))
 			{
+				renameLogPostfixInFLS (put, szNewFileName, newLen);
+				cunilogAddActiveLogfile (bIsActiveLogfile, true, put);
+			}
+			logFromInsideRotatorTextU8fmt	(
+				put, "File \"%s\" moved/renamed to \"%s\".",
+				put->mbFilToRotate.buf.pcc,
+				prd->mbDstFile.buf.pcc
+											);
+		} else
+		{
+			#ifdef PLATFORM_IS_WINDOWS
 				char szErr [CUNILOG_STD_MSG_SIZE];
 				DWORD dwErr = GetLastErrorAndMessage (szErr);
 
@@ -4761,11 +7146,17 @@ static void cunilogRenameLogfile (CUNILOG_TARGET *put)
 					"Error %s while attempting to move file \"%s\" to \"%s\".",
 					szErr, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
 												);
-				SetCunilogError (put, CUNILOG_ERROR_RENAMING_LOGFILE, dwErr);
-			}
-		#else
-			bMoved = false;
-		#endif
+			#else
+				DWORD dwErr = errno;
+
+				logFromInsideRotatorTextU8fmt	(
+					put,
+					"Error %d while attempting to move file \"%s\" to \"%s\".",
+					(int) dwErr, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
+												);
+			#endif
+			SetCunilogError (put, CUNILOG_ERROR_RENAMING_LOGFILE, dwErr);
+		}
 	}
 }
 
@@ -4816,6 +7207,109 @@ static inline void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
 	}
 }
 
+/*
+	Returns true if the files list entry is a logfile that has been compressed to a ".gz"
+	archive, i.e. its name ends with ".log.gz".
+*/
+static inline bool isArchiveInFLS (const CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL	(pfls);
+	ubf_assert_non_NULL	(pfls->chFilename);
+
+	return
+			pfls->stFilename > sizCunilogGzpFileNameExtension
+		&&	0 == memcmp	(
+						pfls->chFilename + pfls->stFilename - sizCunilogGzpFileNameExtension,
+						szCunilogGzpFileNameExtension,
+						lenCunilogGzpFileNameExtension
+						);
+}
+
+/*
+	Returns true if the logfile name ends with ".log" or ".log.gz". The search mask
+	"<app>_<stamp>.log*" of date/time postfixes matches other files too.
+*/
+static inline bool endsLogFileNameWithLogOrArchive (const CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL	(pfls);
+	ubf_assert_non_NULL	(pfls->chFilename);
+
+	return
+			isArchiveInFLS (pfls)
+		||	(
+					pfls->stFilename > sizCunilogLogFileNameExtension
+				&&	0 == memcmp	(
+								pfls->chFilename + pfls->stFilename - sizCunilogLogFileNameExtension,
+								szCunilogLogFileNameExtension,
+								lenCunilogLogFileNameExtension
+								)
+			);
+}
+
+/*
+	Returns the size of the file put->mbFilToRotate, or 0 if it can't be obtained.
+*/
+static uint64_t sizeOfFileToRotate (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	uint64_t	uiRet	= 0;
+
+	#if defined (PLATFORM_IS_WINDOWS)
+		HANDLE h = CreateFileU8	(
+						put->mbFilToRotate.buf.pcc, FILE_READ_ATTRIBUTES,
+						FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+						NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+								);
+		if (INVALID_HANDLE_VALUE != h)
+		{
+			LARGE_INTEGER	li;
+			if (GetFileSizeEx (h, &li))
+				uiRet = (uint64_t) li.QuadPart;
+			CloseHandle (h);
+		}
+	#elif defined (PLATFORM_IS_POSIX)
+		struct stat	st;
+		if (0 == stat (put->mbFilToRotate.buf.pcc, &st))
+			uiRet = (uint64_t) st.st_size;
+	#endif
+	return uiRet;
+}
+
+static inline void prepareU8fullFileNameToRotate (CUNILOG_TARGET *put, size_t idx);
+
+/*
+	Replaces the files list entry idx of a logfile that has just been compressed with its
+	".gz" archive, and the entry's size with the size of the archive. The archive then
+	counts towards the size budget, and rotators that move logfiles to the recycle bin or
+	delete them process it like any other logfile. See member uiMaxTotalSize of
+	CUNILOG_ROTATION_DATA.
+*/
+static void replaceLogfileWithArchiveInFLS (CUNILOG_TARGET *put, size_t idx)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(idx < put->fls.length);
+
+	CUNILOG_FLS	*pfls	= &put->fls.data [idx];
+	const char	*szGz	= szCunilogGzpFileNameExtension + lenCunilogLogFileNameExtension;
+	size_t		lnGz	= lenCunilogGzpFileNameExtension - lenCunilogLogFileNameExtension;
+	size_t		stName	= pfls->stFilename + lnGz;
+	char		*szName	= GetAlignedMemFromSBULKMEMgrow (&put->sbm, stName);
+
+	if (szName)
+	{
+		memcpy (szName, pfls->chFilename, pfls->stFilename - 1);
+		memcpy (szName + pfls->stFilename - 1, szGz, lnGz + 1);
+		pfls->chFilename	= szName;
+		pfls->stFilename	= stName;
+		prepareU8fullFileNameToRotate (put, idx);
+		pfls->uiSize		= sizeOfFileToRotate (put);
+	} else
+	{	// The archive is picked up again when the logging folder is read.
+		vec_splice (&put->fls, idx, 1);
+	}
+}
+
 static inline void cunilogCompressLogfile (CUNILOG_ROTATOR_ARGS *prg)
 {
 	ubf_assert_non_NULL (prg);
@@ -4850,6 +7344,17 @@ static inline void cunilogCompressLogfile (CUNILOG_ROTATOR_ARGS *prg)
 			put, "File \"%s\" compressed (deflated).",
 			put->mbFilToRotate.buf.pcc
 										);
+		uint64_t ui;
+		if (hasDotNumberPostfix (put))
+		{	// The uncompressed file has been deleted. Its ".gz" replacement is not added
+			//	to the files list because renaming the dot numbers doesn't apply to it,
+			//	and it is filtered out by endsLogFileNameWithDotNumber () when the folder
+			//	is read. Its number is still taken.
+			if (dotNumberFromFLS (&ui, &put->fls.data [prg->idx]) && ui > put->uiArchivedDotNumber)
+				put->uiArchivedDotNumber = ui;
+			vec_splice (&put->fls, prg->idx, 1);
+		} else
+			replaceLogfileWithArchiveInFLS (put, prg->idx);
 	} else
 	{
 		dwErr = GetLastErrorAndMessage (szErr);
@@ -4994,7 +7499,7 @@ static inline void cunilogMoveFileToRecycleBin (CUNILOG_TARGET *put)
 		ubf_assert_non_NULL	(put->prargs->cup->pData);
 	
 		logFromInsideRotatorTextU8fmt (put, "Deleting obsolete logfile \"%s\"...\n", put->mbFilToRotate.buf.pch);
-		int i = unlink (put->mbFilToRotate.buf.pch);
+		int i = cunilogUnlinkInLogFold (put, put->mbFilToRotate.buf.pcc);
 		if (0 == i)
 		{
 			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" deleted.\n", put->mbFilToRotate.buf.pch);
@@ -5042,6 +7547,10 @@ static inline void performCompression (CUNILOG_ROTATOR_ARGS *prg)
 	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
 	ubf_assert_non_NULL (put);
 
+	// Already compressed to a ".gz" archive.
+	if (isArchiveInFLS (&put->fls.data [prg->idx]))
+		return;
+
 	enum enClgCmprsMtd comprMethod;
 	comprMethod = (prd->uiFlgs & CUNILOG_ROTATOR_COMPRESS_OBTAIN) >> CUNILOG_ROTATOR_COMPRESS_SHIFT;
 	switch (comprMethod)
@@ -5129,7 +7638,9 @@ static inline void prepareU8fullFileNameToRotate (CUNILOG_TARGET *put, size_t id
 	size_t		sizName = put->fls.data [idx].stFilename;
 	ubf_assert_non_0 (sizName);
 
-	growToSizeSMEMBUF (&put->mbFilToRotate, put->lnLogPath + sizName);
+	// The logging path in front of the name must be retained. Names of ".gz" archives
+	//	are longer than the one the buffer has been created for.
+	growToSizeRetainSMEMBUF (&put->mbFilToRotate, put->lnLogPath + sizName);
 	if (isUsableSMEMBUF (&put->mbFilToRotate))
 	{
 		memcpy (put->mbFilToRotate.buf.pch + put->lnLogPath, strNam, sizName);
@@ -5186,6 +7697,30 @@ static int flscmp_dotnum (const void *p1, const void *p2)
 	return r;
 }
 
+/*
+	Sort order for the monotonic dot number mode (target option flag
+	CUNILOGTARGET_DOTNUMBER_MONOTONIC). The active logfile "file.log" comes first, followed
+	by the remaining logfiles with descending numbers, i.e. "file.log", "file.log.900",
+	"file.log.899", etc. Like with flscmp_dotnum () for the default mode, the most recent
+	logfile is first.
+*/
+static int flscmp_dotnum_monotonic (const void *p1, const void *p2)
+{
+	const CUNILOG_FLS	*fls1 = p1;
+	const CUNILOG_FLS	*fls2 = p2;
+	uint64_t			ui1;
+	uint64_t			ui2;
+
+	bool b1 = dotNumberFromFLS (&ui1, fls1);
+	bool b2 = dotNumberFromFLS (&ui2, fls2);
+
+	if (!b1 || !b2)
+		return (int) b1 - (int) b2;
+	if (ui1 == ui2)
+		return 0;
+	return ui1 > ui2 ? -1 : 1;
+}
+
 static int flscmp_default (const void *p1, const void *p2)
 {
 	const CUNILOG_FLS	*fls1 = p1;
@@ -5220,7 +7755,13 @@ static inline bool needReverseFLS (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup)
 
 	CUNILOG_ROTATION_DATA	*prd = cup->pData;
 	
-	bool bRet = hasDotNumberPostfix (put) && cunilogrotationtask_RenameLogfiles != prd->tsk;
+	// In monotonic mode the renaming rotator only renames the active logfile, which
+	//	therefore needs to be the first file it comes across.
+	bool bRet	=		hasDotNumberPostfix (put)
+				&&	(
+							cunilogrotationtask_RenameLogfiles != prd->tsk
+						||	cunilogHasDotNumberMonotonic (put)
+					);
 	return bRet;
 }
 
@@ -5247,8 +7788,12 @@ static inline void sortLogfilesList (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup
 		if (!cunilogTargetHasFLSisSorted (put))
 		{
 			if (hasDotNumberPostfix (put))
-				vec_sort (&put->fls, flscmp_dotnum);
-			else
+			{
+				if (cunilogHasDotNumberMonotonic (put))
+					vec_sort (&put->fls, flscmp_dotnum_monotonic);
+				else
+					vec_sort (&put->fls, flscmp_dotnum);
+			} else
 				vec_sort (&put->fls, flscmp_default);
 			cunilogTargetSetFLSisSorted (put);
 		}
@@ -5323,7 +7868,14 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 		CUNILOG_FLS	fls;
 		fls.stFilename = psdE->lnFileNameU8 + 1;
 		fls.chFilename = psdE->szFileNameU8;
+		fls.uiSize		=	((uint64_t) psdE->pwfd->nFileSizeHigh << 32)
+						|	psdE->pwfd->nFileSizeLow;
 		if (hasDotNumberPostfix (put) && !endsLogFileNameWithDotNumber (&fls))
+		{
+			recordArchivedDotNumber (put, fls.chFilename, fls.stFilename - 1);
+			return true;
+		}
+		if (!hasDotNumberPostfix (put) && !endsLogFileNameWithLogOrArchive (&fls))
 			return true;
 
 		fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
@@ -5341,6 +7893,31 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 		return true;
 	}
 #elif defined (PLATFORM_IS_POSIX)
+	/*
+		Returns the size of the file szName in the logging folder, or 0 if it can't be
+		obtained. This is the file's logical size, like the size Windows reports for the
+		files list. See member uiMaxTotalSize of CUNILOG_ROTATION_DATA.
+	*/
+	static uint64_t sizeOfLogfileInLogFold (CUNILOG_TARGET *put, const char *szName, size_t stName)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (szName);
+
+		struct stat	st;
+		int			iStat	= -1;
+		if (-1 != put->fdLogFold)
+			iStat = fstatat (put->fdLogFold, szName, &st, 0);
+		else
+		if (put->lnLogPath + stName <= PATH_MAX)
+		{	// The folder has been read by name.
+			char	szPath [PATH_MAX];
+			memcpy (szPath, put->mbLogPath.buf.pcc, put->lnLogPath);
+			memcpy (szPath + put->lnLogPath, szName, stName);
+			iStat = stat (szPath, &st);
+		}
+		return 0 == iStat ? (uint64_t) st.st_size : 0;
+	}
+
 	static bool obtainLogfilesListToRotateCallbackPsx (SONEDIRENT *pod)
 	{
 		ubf_assert_non_NULL (pod);
@@ -5349,6 +7926,7 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 
 		CUNILOG_FLS fls;
 		fls.stFilename = strlen (pod->dirEnt->d_name) + 1;
+		fls.chFilename = pod->dirEnt->d_name;
 		if	(
 				globMatch	(
 					pod->dirEnt->d_name, fls.stFilename - 1,
@@ -5356,6 +7934,18 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 							)
 			)
 		{
+			// The mask "<app>.log*" matches compressed logfiles "<app>.log.<n>.gz" too.
+			if (hasDotNumberPostfix (put) && !endsLogFileNameWithDotNumber (&fls))
+			{
+				recordArchivedDotNumber (put, fls.chFilename, fls.stFilename - 1);
+				return true;
+			}
+			// The mask "<app>_<stamp>.log*" matches ".gz" archives, which stay in the list.
+			if (!hasDotNumberPostfix (put) && !endsLogFileNameWithLogOrArchive (&fls))
+				return true;
+
+			// Only obtained when the folder is read. The size is tracked afterwards.
+			fls.uiSize = sizeOfLogfileInLogFold (put, pod->dirEnt->d_name, fls.stFilename);
 			fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
 			ubf_assert_non_NULL (fls.chFilename);
 			if (fls.chFilename)
@@ -5400,21 +7990,44 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 		ubf_assert			(strlen (put->mbLogPath.buf.pcc)		== put->lnLogPath);
 		ubf_assert			(strlen (put->mbLogFileMask.buf.pcc)	== put->lnLogFileMask);
 
-		uint64_t n;
-		n = ForEachPsxDirEntry	(
-				put->mbLogFold.buf.pcc,						// Directory name.
-				obtainLogfilesListToRotateCallbackPsx, put, NULL
-								);
+		uint64_t	n;
+		int			fdFold	= cunilogLogFoldFD (put);
+		if (-1 == fdFold)
+		{
+			n = ForEachPsxDirEntry	(
+					put->mbLogFold.buf.pcc,					// Directory name.
+					obtainLogfilesListToRotateCallbackPsx, put, NULL
+									);
+		} else
+		{
+			n = ForEachPsxDirEntryAt	(
+					fdFold,
+					obtainLogfilesListToRotateCallbackPsx, put, NULL
+										);
+		}
 		UNUSED (n);
 	}
 #endif
 
+/*
+	The files list is kept across events and only read from disk if it's empty. It is
+	discarded when the modification time of the logging folder differs from the one
+	recorded when the list was last known to be in sync with the folder, which means
+	that something other than this target has modified the folder.
+*/
 static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	uint64_t uiMtime = cunilogLogFolderMtime (put);
+	if (put->fls.length && uiMtime != put->uiLogFoldMtime)
+		cunilogResetFilesList (put);
+
 	if (0 == put->fls.length)
 	{
+		// Obtained before the folder is read. A modification during the scan
+		//	causes another scan the next time.
+		put->uiLogFoldMtime = uiMtime;
 		#if defined (PLATFORM_IS_WINDOWS)
 			obtainLogfilesListToRotateWin (put);
 		#elif defined (PLATFORM_IS_POSIX)
@@ -5434,34 +8047,43 @@ static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
 	DebugOutputFilesList ("obtainLogfilesListToRotate", &put->fls);
 }
 
-static inline void cunilogResetFilesList (CUNILOG_TARGET *put)
+static inline void prepareLogFileMask (CUNILOG_TARGET *put, CUNILOG_ROTATION_DATA *prd)
 {
-	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+	ubf_assert_non_NULL	(prd);
 
-	vec_clear (&put->fls);
-	EmptySBULKMEM (&put->sbm);
-	cunilogTargetClrFLSisSorted (put);
+	// Both masks match ".gz" archives too.
+	UNUSED (prd);
+	if (hasDotNumberPostfix (put))
+		createLogfilesSearchMaskDotNumberPostfix (put);
+	else
+		createLogfilesSearchMask (put);
 }
 
-static inline void prepareLogFileMask (CUNILOG_TARGET *put, CUNILOG_ROTATION_DATA *prd)
+/*
+	Returns true if the files list entry idx is the current logfile.
+*/
+static inline bool isCurrentLogfileInFLS (CUNILOG_TARGET *put, size_t idx)
 {
 	ubf_assert_non_NULL	(put);
-	ubf_assert			(cunilogIsTargetInitialised (put));
-	ubf_assert_non_NULL	(prd);
+	ubf_assert			(idx < put->fls.length);
 
-	if (cunilogHasRotator_COMPRESS_GZIPCOMP (prd))
-	{
-		ubf_assert (false);
-	} else
-	{
-		if (hasDotNumberPostfix (put))
-			createLogfilesSearchMaskDotNumberPostfix (put);
-		else
-		if (hasLogPostfix (put))
-			createLogfilesSearchMask (put);
-		else
-			createLogfilesSearchMask (put);
-	}
+	return !strcmp (put->fls.data [idx].chFilename, put->mbLogfileName.buf.pcc + put->lnLogPath);
+}
+
+/*
+	Returns the size of the files list entry idx. The size of the current logfile is
+	tracked separately because it grows with every event written to it.
+*/
+static inline uint64_t sizeOfFLSentry (CUNILOG_TARGET *put, size_t idx)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(idx < put->fls.length);
+
+	return	isCurrentLogfileInFLS (put, idx)
+			? put->uiLogfileSize
+			: put->fls.data [idx].uiSize;
 }
 
 static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
@@ -5490,6 +8112,18 @@ static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 
 		nMaxToRot = 1;										// Only "<appname>.log" needs rotation.
 	} else
+	if (cunilogrotationtask_RenameLogfiles == prd->tsk && cunilogHasDotNumberMonotonic (put))
+	{	// Only "<appname>.log" is renamed, to "<appname>.log.<highest number + 1>".
+		//	The list is sorted and reversed, hence it's the last entry if it exists.
+		ubf_assert (hasDotNumberPostfix (put));
+
+		size_t sizActive = put->lnAppName + sizCunilogLogFileNameExtension;
+		nToIgnore = 0;
+		nMaxToRot	=		put->fls.length
+						&&	sizActive == put->fls.data [put->fls.length - 1].stFilename
+					?	1
+					:	0;
+	} else
 	{
 		nMaxToRot	=	CUNILOG_MAX_ROTATE_AUTO - nToIgnore <= prd->nMaxToRotate
 					?	prd->nMaxToRotate
@@ -5497,13 +8131,24 @@ static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 	}
 	DebugOutputFilesList ("List out", &put->fls);
 
-	size_t iFiles = put->fls.length;
+	bool		bRotated	= false;
+	bool		bOverBudget	= false;
+	uint64_t	uiTotalSize	= 0;
+	size_t		iFiles		= put->fls.length;
 	while (iFiles --)
 	{
 		ubf_assert (iFiles < put->fls.length);
 		//puts (put->fls.data [iFiles].chFilename);
 		++ prd->nCnt;
-		if (prd->nCnt > nToIgnore)
+		if (prd->uiMaxTotalSize && !bOverBudget)
+		{	// This file and all more recent ones. Once the budget is exceeded, all less
+			//	recent files are rotated too.
+			uiTotalSize += sizeOfFLSentry (put, iFiles);
+			bOverBudget	= uiTotalSize > prd->uiMaxTotalSize;
+		}
+		// The current logfile is never rotated because of the size budget.
+		bool bBudget = bOverBudget && !isCurrentLogfileInFLS (put, iFiles);
+		if (prd->nCnt > nToIgnore || bBudget)
 		{
 			if (prd->nCnt <= nMaxToRot)
 			{
@@ -5519,6 +8164,7 @@ static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 				prg->siz = put->fls.data [iFiles].stFilename;
 				prg->idx = iFiles;
 				performActualRotation (prg);
+				bRotated = true;
 			} else
 				break;
 		} else
@@ -5526,6 +8172,9 @@ static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 			++ put->scuNPI.nIgnoredTotal;
 		}
 	}
+	// The files list has been updated by the rotation functions.
+	if (bRotated)
+		cunilogFilesListInSync (put);
 	DebugOutputFilesList ("List out", &put->fls);
 }
 
@@ -5572,10 +8221,162 @@ static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EV
 	return true;
 }
 
+/*
+	Hands the pending event lines of the custom processor cup to its batch callback
+	function.
+*/
+static void cunilogFlushCustBatch (CUNILOG_PROCESSOR *cup)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert			(cunilogProcessCustomProcessor == cup->task);
+
+	CUNILOG_CUSTPROCESS	*pcu = cup->pData;
+	ubf_assert_non_NULL (pcu);
+
+	CUNILOG_CUSTBATCH	*pcb = cup->pcb;
+	if (NULL == pcb || 0 == pcb->nEntries)
+		return;
+	ubf_assert_non_NULL (pcu->procBatch);
+
+	CUNILOG_CUSTLINE	*pcl	= pcb->mbEntries.buf.pvoid;
+	const char			*szLine	= pcb->mbLines.buf.pcc;
+	size_t				n;
+	for (n = 0; n < pcb->nEntries; ++ n)
+	{
+		pcl [n].szLine = szLine;
+		szLine += pcl [n].lnLine + 1;
+	}
+	pcu->procBatch (cup, pcl, pcb->nEntries);
+	pcb->lnLines	= 0;
+	pcb->nEntries	= 0;
+}
+
+/*
+	Hands the pending event lines of all custom processors of the target put to their
+	batch callback functions. Called at the end of each batch of events.
+*/
+static void cunilogFlushCustBatches (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	unsigned int ui;
+	for (ui = 0; ui < put->nprocessors; ++ ui)
+	{
+		CUNILOG_PROCESSOR *cup = put->cprocessors [ui];
+		if (cunilogProcessCustomProcessor == cup->task)
+			cunilogFlushCustBatch (cup);
+	}
+}
+
+static void cunilogDoneCustBatch (CUNILOG_PROCESSOR *cup)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert			(cunilogProcessCustomProcessor == cup->task);
+
+	if (cup->pcb)
+	{
+		cunilogFlushCustBatch (cup);
+		freeSMEMBUF (&cup->pcb->mbLines);
+		freeSMEMBUF (&cup->pcb->mbEntries);
+		ubf_free (cup->pcb);
+		cup->pcb = NULL;
+	}
+}
+
+/*
+	Appends the event line szLine with length lnLine of the event pev to the pending
+	batch of the custom processor cup.
+*/
+static bool cunilogAddToCustBatch	(
+				CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev, const char *szLine, size_t lnLine
+									)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (szLine);
+
+	if (NULL == cup->pcb)
+	{
+		cup->pcb = ubf_malloc (sizeof (CUNILOG_CUSTBATCH));
+		if (NULL == cup->pcb)
+			return false;
+		initSMEMBUF (&cup->pcb->mbLines);
+		initSMEMBUF (&cup->pcb->mbEntries);
+		cup->pcb->lnLines	= 0;
+		cup->pcb->nEntries	= 0;
+	}
+	CUNILOG_CUSTBATCH	*pcb = cup->pcb;
+
+	if	(
+				!growToSizeRetainSMEMBUF (&pcb->mbLines, pcb->lnLines + lnLine + 1)
+			||	!growToSizeRetainSMEMBUF	(
+					&pcb->mbEntries, (pcb->nEntries + 1) * sizeof (CUNILOG_CUSTLINE)
+											)
+		)
+		return false;
+
+	memcpy (pcb->mbLines.buf.pch + pcb->lnLines, szLine, lnLine);
+	pcb->mbLines.buf.pch [pcb->lnLines + lnLine] = ASCII_NUL;
+	pcb->lnLines += lnLine + 1;
+
+	CUNILOG_CUSTLINE	*pcl = (CUNILOG_CUSTLINE *) pcb->mbEntries.buf.pvoid + pcb->nEntries;
+	pcl->szLine		= NULL;									// Set when flushed.
+	pcl->lnLine		= lnLine;
+	pcl->evSeverity	= pev->evSeverity;
+	pcl->stamp		= pev->stamp;
+	++ pcb->nEntries;
+	return true;
+}
+
+/*
+	A custom processor with a batch callback function. The event line is collected for the
+	batch of events the separate logging thread is working through. Without a separate
+	logging thread, each event is a batch of its own.
+*/
+static bool cunilogProcessCustomBatchFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+
+	CUNILOG_TARGET		*put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+
+	// Control codes are only meant for terminals.
+	if (cunilogEvtTypeControlCode == pev->evType)
+		return true;
+
+	const char			*szLine;
+	size_t				lnLine;
+	if (optCunProcHasOPT_CUNPROC_JSON (cup->uiOpts))
+	{
+		if (CUNILOG_SIZE_ERROR == cunilogJSONLineFromEvent (pev))
+		{
+			cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_HEAP_ALLOCATION, cup, pev);
+			return false;
+		}
+		szLine = put->mbJSONLine.buf.pcc;
+		lnLine = put->lnJSONLine;
+	} else
+	{
+		szLine = put->mbLogEventLine.buf.pcc;
+		lnLine = put->lnLogEventLine;
+	}
+
+	if (!cunilogAddToCustBatch (cup, pev, szLine, lnLine))
+	{
+		cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_HEAP_ALLOCATION, cup, pev);
+		return false;
+	}
+	if (!HAS_CUNILOG_TARGET_A_QUEUE (put))
+		cunilogFlushCustBatch (cup);
+	return true;
+}
+
 /*
 	The custom processor. Its pData member is a pointer to a CUNILOG_CUSTPROCESS structure,
-	which has two members: pData for custom data and the function pointer procFnc, which
-	is the actual custom processor function.
+	which holds the custom data pCust, the processor function procFnct, and the cleanup
+	function procDone. If the processor has the option flag OPT_CUNPROC_BATCH, the event
+	line is collected for its batch callback function procBatch instead of calling procFnct.
 */
 static bool cunilogProcessCustomProcessorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
@@ -5589,6 +8390,11 @@ static bool cunilogProcessCustomProcessorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_E
 
 	CUNILOG_CUSTPROCESS	*pcu = cup->pData;
 	ubf_assert_non_NULL (pcu);
+	if (optCunProcHasOPT_CUNPROC_BATCH (cup->uiOpts))
+	{
+		ubf_assert_non_NULL (pcu->procBatch);
+		return cunilogProcessCustomBatchFnct (cup, pev);
+	}
 	ubf_assert_non_NULL (pcu->procFnct);
 	return pcu->procFnct (cup, pev);
 }
@@ -5613,7 +8419,11 @@ static bool cunilogProcessTargetRedirectorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_
 	if (put)
 	{
 		ubf_assert (cunilogIsTargetInitialised (put));
-		logEv (put, pev);
+		// The event itself is destroyed by its current target when we return.
+		cunilogCacheEventLine (pev);
+		CUNILOG_EVENT *pnev = cunilogShareCUNILOG_EVENT (pev);
+		if (pnev)
+			logEv (put, pnev);
 		return false;										// Ignore remaining processors.
 	}
 	return true;
@@ -5629,11 +8439,127 @@ static bool cunilogProcessTargetForkFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT
 
 	if (put)
 	{
-		CUNILOG_EVENT *pnev = DuplicateCUNILOG_EVENT (pev);
+		cunilogCacheEventLine (pev);
+		CUNILOG_EVENT *pnev = cunilogShareCUNILOG_EVENT (pev);
 		if (pnev)
 		{
-			logEv (put, pev);
+			logEv (put, pnev);
+		}
+	}
+	return true;
+}
+
+static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup);
+
+/*
+	Passes a "Last message repeated <n> times." event for the cunilogProcessCollapseDuplicates
+	processor cup to the processors that follow it. Note that this overwrites the event line
+	of the target.
+*/
+static void cunilogProcessCollapseSummary (CUNILOG_PROCESSOR *cup, CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (put);
+
+	CUNILOG_COLLAPSE_DATA *pcd = cup->pData;
+	ubf_assert_non_NULL (pcd);
+	ubf_assert_non_0	(pcd->nRepeated);
+
+	char	szSum [CUNILOG_STD_MSG_SIZE];
+	int		len = snprintf	(
+					szSum, CUNILOG_STD_MSG_SIZE,
+					"Last message repeated %" PRIu64 " times.", pcd->nRepeated
+							);
+	pcd->nRepeated = 0;
+
+	CUNILOG_EVENT *pes = CreateCUNILOG_EVENT_Text (put, pcd->sevLast, szSum, (size_t) len);
+	if (pes)
+	{
+		if (CUNILOG_SIZE_ERROR != createEventLineFromCUNILOG_EVENT (pes))
+		{
+			unsigned int ui = 0;
+			while (ui < put->nprocessors && cup != put->cprocessors [ui])
+				++ ui;
+			for (++ ui; ui < put->nprocessors; ++ ui)
+			{
+				if (!cunilogProcessProcessor (pes, put->cprocessors [ui]))
+					break;
+			}
+		}
+		DoneCUNILOG_EVENT (put, pes);
+	}
+}
+
+/*
+	Reports the runs of identical events that have not ended yet. Called when the target
+	shuts down.
+*/
+static void cunilogFlushCollapsedRuns (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	unsigned int ui;
+	for (ui = 0; ui < put->nprocessors; ++ ui)
+	{
+		CUNILOG_PROCESSOR *cup = put->cprocessors [ui];
+		if	(
+					cunilogProcessCollapseDuplicates == cup->task
+				&&	((CUNILOG_COLLAPSE_DATA *) cup->pData)->nRepeated
+			)
+			cunilogProcessCollapseSummary (cup, put);
+	}
+}
+
+/*
+	The processor that collapses runs of identical events. Only normal text events that
+	haven't been created by Cunilog itself take part. Other events pass unchanged.
+*/
+static bool cunilogProcessCollapseDuplicatesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+
+	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
+	CUNILOG_COLLAPSE_DATA	*pcd = cup->pData;
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (pcd);
+
+	if (cunilogEvtTypeNormalText != pev->evType || cunilogIsEventInternal (pev))
+		return true;
+
+	if	(
+				isUsableSMEMBUF (&pcd->mbLast)
+			&&	pev->evSeverity		== pcd->sevLast
+			&&	pev->lenDataToLog	== pcd->lnLast
+			&&	!memcmp (pev->szDataToLog, pcd->mbLast.buf.pcc, pcd->lnLast)
+		)
+	{
+		++ pcd->nRepeated;
+		if (pcd->uiMaxMs)
+		{	// FILETIME ticks are 100 ns.
+			uint64_t uiNow = GetSystemTimeAsULONGLONGrel ();
+			if (uiNow - pcd->uiRunStart >= pcd->uiMaxMs * 10000)
+			{
+				cunilogProcessCollapseSummary (cup, put);
+				pcd->uiRunStart = uiNow;
+			}
 		}
+		return false;										// Swallowed.
+	}
+
+	if (pcd->nRepeated)
+	{
+		cunilogProcessCollapseSummary (cup, put);
+		// The summary has overwritten the event line of the target.
+		createEventLineFromCUNILOG_EVENT (pev);
+	}
+	if (growToSizeSMEMBUF (&pcd->mbLast, pev->lenDataToLog + 1))
+	{
+		memcpy (pcd->mbLast.buf.pch, pev->szDataToLog, pev->lenDataToLog);
+		pcd->lnLast		= pev->lenDataToLog;
+		pcd->sevLast	= pev->evSeverity;
+		if (pcd->uiMaxMs)
+			pcd->uiRunStart = GetSystemTimeAsULONGLONGrel ();
 	}
 	return true;
 }
@@ -5713,6 +8639,8 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 			put->qu.last		= pev;
 			put->qu.num			= 1;
 		}
+		if (put->shed.nStages)
+			raiseSheddingCUNILOG_TARGET (put);
 		r = nToTrigger (put);
 		LeaveCUNILOG_LOCKER (put);
 		return r;
@@ -5863,6 +8791,7 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 		{
 			CUNILOG_EVENT *pev = DequeueAllCUNILOG_EVENTs (put);
 			CUNILOG_EVENT *pnx;
+			size_t			nDequeued	= 0;
 			while (pev)
 			{	// Remember the next pointer because pev is going to be destroyed
 				//	by DoneSUNILOGEVENT (), which is called by
@@ -5870,7 +8799,12 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 				pnx = pev->next;
 				cunilogProcessEventSingleThreaded (pev);
 				pev = pnx;
+				++ nDequeued;
 			}
+			endSheddingCUNILOG_TARGET (put, nDequeued);
+			// End of the batch.
+			cunilogFlushCustBatches (put);
+			cunilogFlushCoutBuffer (put);
 			ubf_assert_size_t (put->nPendingNoRotEvts);
 			if (cunilogTargetHasShutdownInitiatedFlag (put) && 0 == put->nPendingNoRotEvts)
 				goto ExitSeparateLoggingThread;
@@ -5928,6 +8862,42 @@ static inline bool updateThresholdForAppliesToTimes (CUNILOG_PROCESSOR *cup)
 	return bRet;
 }
 
+/*
+	Returns the value for cunilogProcessAppliesTo_WeekChanged, which consists of the
+	ISO 8601 year in the year bits of a UBF_TIMESTAMP plus the ISO 8601 week number.
+	The ISO year is required because the last days of December can belong to week 01 of
+	the next year and the first days of January to week 52 or 53 of the previous one.
+
+	The week can only change when the day changes. The value is therefore cached per
+	target and only computed for the first event of a day. The stamp is always greater
+	than 0, which means the initial day of 0 never matches.
+*/
+static inline uint64_t cunilogWeekKeyFromEvent (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	CUNILOG_TARGET	*put	= pev->pCUNILOG_TARGET;
+	uint64_t		uiDay	= pev->stamp & UBF_TIMESTAMP_KEEP_FROM_DAY_BITS;
+
+	if (uiDay != put->uiWeekKeyDay)
+	{
+		uint32_t	uiYear;
+		uint8_t		uiWeek	= GetISO8601WeekNumberFromDate	(
+								UBF_TIMESTAMP_YEAR	(pev->stamp),
+								UBF_TIMESTAMP_MONTH	(pev->stamp),
+								UBF_TIMESTAMP_DAY	(pev->stamp),
+								&uiYear
+															);
+		// The year bits of a UBF_TIMESTAMP start in 2000. See UBF_TIMESTAMP_YEAR ().
+		put->uiWeekKey		=	uiYear >= 2000
+							?	((uint64_t) (uiYear - 2000) << 54) + uiWeek
+							:	(pev->stamp & UBF_TIMESTAMP_KEEP_FROM_YEAR_BITS) + uiWeek;
+		put->uiWeekKeyDay	= uiDay;
+	}
+	return put->uiWeekKey;
+}
+
 static inline bool updateCurrentValueAndIsThresholdReached	(
 								CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
 															)
@@ -6002,13 +8972,7 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 			bRet = updateThresholdForAppliesToTimes (cup);
 			break;
 		case cunilogProcessAppliesTo_WeekChanged:
-			cup->cur = (pev->stamp & UBF_TIMESTAMP_KEEP_FROM_YEAR_BITS)
-					 + 	GetISO8601WeekNumberFromDate (
-							UBF_TIMESTAMP_YEAR	(pev->stamp),
-							UBF_TIMESTAMP_MONTH	(pev->stamp),
-							UBF_TIMESTAMP_DAY	(pev->stamp),
-							NULL
-													);
+			cup->cur = cunilogWeekKeyFromEvent (pev);
 			bRet = updateThresholdForAppliesToTimes (cup);
 			break;
 		case cunilogProcessAppliesTo_MonthChanged:
@@ -6051,20 +9015,24 @@ static bool (*pickAndRunProcessor [cunilogProcessXAmountEnumValues]) (CUNILOG_PR
 	/* cunilogProcessCustomProcessor	*/	,	cunilogProcessCustomProcessorFnct
 	/* cunilogProcessTargetRedirector	*/	,	cunilogProcessTargetRedirectorFnct
 	/* cunilogProcessTargetFork			*/	,	cunilogProcessTargetForkFnct
+	/* cunilogProcessCollapseDuplicates	*/	,	cunilogProcessCollapseDuplicatesFnct
 };
 
 /*
-	Returns true for further processing by the caller.
+	Runs the processor cup with its processor function fnc if its threshold has been reached.
+	Returns true if the next processor is to be run too.
 */
-static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup)
+static inline bool cunilogRunProcessor	(
+				CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup,
+				bool (*fnc) (CUNILOG_PROCESSOR *, CUNILOG_EVENT *)
+										)
 {
 	ubf_assert_non_NULL	(pev);
 	ubf_assert_non_NULL	(cup);
-	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
-	ubf_assert			(cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
+	ubf_assert_non_NULL	(fnc);
 
-	// If the processor is disabled we move on to the next one unconditionally.
-	if (optCunProcHasOPT_CUNPROC_DISABLED (cup->uiOpts))
+	// Carry on with the next processor if this one doesn't process events with this severity.
+	if (cup->sevSkipMask & ((evtsevmask_t) 1 << pev->evSeverity))
 		return true;
 
 	if (cunilogHasEventCoutOnly (pev) && cunilogProcessOutputToConsole != cup->task)
@@ -6074,7 +9042,7 @@ static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSO
 	if	(updateCurrentValueAndIsThresholdReached (cup, pev))
 	{
 		// True tells the caller to carry on with the next processor.
-		bRetProcessor = pickAndRunProcessor [cup->task] (cup, pev);
+		bRetProcessor = fnc (cup, pev);
 	}
 	
 	if (cunilogProcessOutputToConsole == cup->task && cunilogHasEventCoutOnly (pev))
@@ -6091,6 +9059,135 @@ static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSO
 	 return bRetProcessor;
 }
 
+static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(cup);
+	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
+	ubf_assert			(cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
+
+	// If the processor is disabled we move on to the next one unconditionally.
+	if (optCunProcHasOPT_CUNPROC_DISABLED (cup->uiOpts))
+		return true;
+	return cunilogRunProcessor (pev, cup, pickAndRunProcessor [cup->task]);
+}
+
+/*
+	The execution plan of a target's processors. See CUNILOG_PLAN_ENTRY.
+*/
+static inline uint64_t cunilogPlanMaskFromFrequency (enum cunilogprocessfrequency freq)
+{
+	switch (freq)
+	{
+		case cunilogProcessAppliesTo_SecondChanged:	return UBF_TIMESTAMP_KEEP_FROM_SECOND_BITS;
+		case cunilogProcessAppliesTo_MinuteChanged:	return UBF_TIMESTAMP_KEEP_FROM_MINUTE_BITS;
+		case cunilogProcessAppliesTo_HourChanged:	return UBF_TIMESTAMP_KEEP_FROM_HOUR_BITS;
+		case cunilogProcessAppliesTo_DayChanged:	return UBF_TIMESTAMP_KEEP_FROM_DAY_BITS;
+		case cunilogProcessAppliesTo_MonthChanged:	return UBF_TIMESTAMP_KEEP_FROM_MONTH_BITS;
+		case cunilogProcessAppliesTo_YearChanged:	return UBF_TIMESTAMP_KEEP_FROM_YEAR_BITS;
+		default:
+			// Week numbers are not a range of timestamp bits.
+			return 0;
+	}
+}
+
+/*
+	The threshold of a processor with a time-based frequency is the current period, i.e.
+	the timestamp with all bits below the period cleared. The threshold is reached as soon
+	as an event belongs to a later period. Since the bits of a timestamp are in descending
+	order of significance, this is the case for all timestamps above the threshold with
+	all the bits below the period set.
+*/
+static inline uint64_t cunilogPlanDeadline (CUNILOG_PROCESSOR *cup, uint64_t uiMask)
+{
+	ubf_assert_non_NULL (cup);
+
+	return uiMask && cup->thr ? cup->thr | ~ uiMask : 0;
+}
+
+/*
+	Rebuilds the execution plan of the target put if its configuration has changed.
+	Returns false if there's no plan, in which case the caller works through the
+	processors directly.
+*/
+static bool cunilogPlanCUNILOG_TARGET (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (!put->bPlanOutdated)
+		return true;
+
+	// Cleared first, so that a change while we're building the plan isn't lost.
+	put->bPlanOutdated = false;
+	if (put->pplan)
+		ubf_free (put->pplan);
+	put->nplan = 0;
+	put->pplan = put->nprocessors
+				? ubf_malloc (put->nprocessors * sizeof (CUNILOG_PLAN_ENTRY))
+				: NULL;
+	if (NULL == put->pplan && put->nprocessors)
+	{
+		put->bPlanOutdated = true;
+		return false;
+	}
+
+	unsigned int ui;
+	for (ui = 0; ui < put->nprocessors; ++ ui)
+	{
+		CUNILOG_PROCESSOR *cup = put->cprocessors [ui];
+		if (optCunProcHasOPT_CUNPROC_DISABLED (cup->uiOpts))
+			continue;
+		CUNILOG_PLAN_ENTRY *ppe = &put->pplan [put->nplan ++];
+		ppe->cup		= cup;
+		ppe->fnc		= pickAndRunProcessor [cup->task];
+		ppe->uiMask		= cunilogPlanMaskFromFrequency (cup->freq);
+		ppe->uiDeadline	= cunilogPlanDeadline (cup, ppe->uiMask);
+	}
+	return true;
+}
+
+/*
+	The return value of cunilogRunProcessor () for a processor whose threshold has not
+	been reached.
+*/
+static inline bool cunilogProcessorNotReached (CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(cup);
+
+	if (cup->sevSkipMask & ((evtsevmask_t) 1 << pev->evSeverity))
+		return true;
+	if (cunilogHasEventCoutOnly (pev))
+		return cunilogProcessOutputToConsole != cup->task;
+	return !cunilogEventHasIgnoreRemainingProcessors (pev);
+}
+
+static inline bool cunilogProcessPlanEntry (CUNILOG_EVENT *pev, CUNILOG_PLAN_ENTRY *ppe)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(ppe);
+
+	CUNILOG_PROCESSOR *cup = ppe->cup;
+
+	// The caller might have set OPT_CUNPROC_DISABLED directly, without
+	//	ConfigCUNILOG_TARGETprocessorsChanged (). Same as in cunilogProcessProcessor ().
+	if (optCunProcHasOPT_CUNPROC_DISABLED (cup->uiOpts))
+		return true;
+
+	// A single comparison for processors that cannot run before their deadline, unless
+	//	they're told to run at startup.
+	if	(
+				pev->stamp <= ppe->uiDeadline
+			&&	!optCunProcHasOPT_CUNPROC_AT_STARTUP (cup->uiOpts)
+			&&	!cunilogTargetHasRunProcessorsOnStartup (pev->pCUNILOG_TARGET)
+		)
+		return cunilogProcessorNotReached (pev, cup);
+
+	bool b = cunilogRunProcessor (pev, cup, ppe->fnc);
+	ppe->uiDeadline = cunilogPlanDeadline (cup, ppe->uiMask);
+	return b;
+}
+
 static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL						(pev);
@@ -6107,21 +9204,33 @@ static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
 				cunilogClrEventNoRotation (pev);
 		} else
 		{
+			// The files list is not reset here. See obtainLogfilesListToRotate ().
 			pev->pCUNILOG_TARGET->scuNPI.nIgnoredTotal = 0;
-			cunilogResetFilesList (pev->pCUNILOG_TARGET);
 			cunilogEventClrIgnoreRemainingProcessors (pev);
 		}
 	}
 
-	CUNILOG_PROCESSOR *cup;
+	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
 	unsigned int ui = 0;
-	while (ui < pev->pCUNILOG_TARGET->nprocessors)
+	if (cunilogPlanCUNILOG_TARGET (put))
 	{
-		cup = pev->pCUNILOG_TARGET->cprocessors [ui];
-		bool b = cunilogProcessProcessor (pev, cup);
-		if (!b)
-			break;
-		++ ui;
+		while (ui < put->nplan)
+		{
+			if (!cunilogProcessPlanEntry (pev, &put->pplan [ui]))
+				break;
+			++ ui;
+		}
+	} else
+	{	// No plan. We walk through all processors.
+		CUNILOG_PROCESSOR *cup;
+		while (ui < put->nprocessors)
+		{
+			cup = put->cprocessors [ui];
+			bool b = cunilogProcessProcessor (pev, cup);
+			if (!b)
+				break;
+			++ ui;
+		}
 	}
 
 	if (!cunilogIsEventInternal (pev))
@@ -6156,6 +9265,10 @@ static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev)
 	// Event command flag for shutting down the separate logging thread.
 	if (cunilogIsEventShutdown (pev))
 	{
+		cunilogFlushCollapsedRuns (pev->pCUNILOG_TARGET);
+		cunilogFlushCustBatches (pev->pCUNILOG_TARGET);
+		cunilogFlushCoutBuffer (pev->pCUNILOG_TARGET);
+		cunilogDoneCoutAsync (pev->pCUNILOG_TARGET);
 		cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
 		DoneCUNILOG_EVENT (NULL, pev);
 		// The shutdown event has been processed. We treat this as being success.
@@ -6310,7 +9423,9 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 		NULL, 0,											// Up to lenDataToLog
 		NULL,												// Member *next.
 		cunilogEvtSeverityNone, cunilogEvtTypeNormalText,
-		0													// Member sizEvent.
+		0,													// Member sizEvent.
+		NULL, 0,											// Members pevOwner and nRefs.
+		NULL												// Member plc.
 	};
 #endif
 
@@ -6360,6 +9475,8 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 				cunilogTargetSetShutdownCompleteFlag (put);
 				return true;
 			}
+			// Queued before the shutdown event.
+			cunilogRateLimitReportPending (put);
 			if (queueShutdownEvent (put))
 			{
 				WaitForEndOfSeparateLoggingThread (put);
@@ -6368,6 +9485,13 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 			}
 			return false;
 		}
+		cunilogRateLimitReportPending (put);
+		EnterCUNILOG_LOCKER (put);
+		cunilogFlushCollapsedRuns (put);
+		cunilogFlushCustBatches (put);
+		cunilogFlushCoutBuffer (put);
+		cunilogDoneCoutAsync (put);
+		LeaveCUNILOG_LOCKER (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return true;
 	}
@@ -6376,6 +9500,9 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 	{
 		ubf_assert_non_NULL (put);
 
+		cunilogRateLimitReportPending (put);
+		cunilogFlushCollapsedRuns (put);
+		cunilogFlushCoutBuffer (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return true;
 	}
@@ -6420,72 +9547,329 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 
 		cunilogTargetSetShutdownInitiatedFlag (put);
 		return true;
-	}
-#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	void PauseLogCUNILOG_TARGET (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		EnterCUNILOG_LOCKER (put);
+		cunilogTargetSetIsPaused (put);
+		LeaveCUNILOG_LOCKER (put);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	size_t ResumeLogCUNILOG_TARGET (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		size_t n;
+
+		EnterCUNILOG_LOCKER (put);
+		cunilogTargetClrIsPaused (put);
+		n = put->nPausedEvents;
+		put->nPausedEvents = 0;
+		LeaveCUNILOG_LOCKER (put);
+
+		if (needsOrHasLocker (put))
+			triggerCUNILOG_EVENTloggingThread (put, n);
+		return n;
+	}
+#endif
+
+/*
+	User logging functions.
+*/
+
+bool logEv (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+	ubf_assert_non_NULL (pev);
+
+	bool bRet;
+
+	// Before anything else. An event shared by a fork or redirector processor still
+	//	refers to its previous target, and DoneCUNILOG_EVENT () only destroys events of
+	//	this target.
+	pev->pCUNILOG_TARGET = put;
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+	{
+		bRet = false;
+		goto discardPev;
+	}
+	if (!isSeverityEnabledCUNILOG_TARGET (pev->evSeverity, put))
+	{
+		bRet = true;
+		goto discardPev;
+	}
+
+	return cunilogProcessOrQueueEvent (pev);
+
+	discardPev:
+	DoneCUNILOG_EVENT (put, pev);
+	return bRet;
+}
+
+/*
+	Atomic helpers for CUNILOG_RATELIMIT buckets. A bucket can be used by several threads
+	at the same time, hence these are atomic in single-threaded builds too.
+*/
+static inline uint64_t cunilogRateLimitLoad (volatile uint64_t *pui)
+{
+	#if defined (_MSC_VER)
+		return (uint64_t) InterlockedCompareExchange64 ((volatile LONG64 *) pui, 0, 0);
+	#elif defined(__clang__) || defined(__GNUC__)
+		return __atomic_load_n (pui, __ATOMIC_RELAXED);
+	#else
+		#error Not supported
+	#endif
+}
+
+static inline bool cunilogRateLimitCAS (volatile uint64_t *pui, uint64_t *puiExp, uint64_t uiNew)
+{
+	#if defined (_MSC_VER)
+		uint64_t uiPrev = (uint64_t) InterlockedCompareExchange64	(
+										(volatile LONG64 *) pui,
+										(LONG64) uiNew, (LONG64) *puiExp
+																	);
+		if (uiPrev == *puiExp)
+			return true;
+		*puiExp = uiPrev;
+		return false;
+	#elif defined(__clang__) || defined(__GNUC__)
+		return __atomic_compare_exchange_n	(
+					pui, puiExp, uiNew, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+											);
+	#else
+		#error Not supported
+	#endif
+}
+
+static inline uint64_t cunilogRateLimitTakeSuppressed (CUNILOG_RATELIMIT *prl)
+{
+	#if defined (_MSC_VER)
+		return (uint64_t) InterlockedExchange64 ((volatile LONG64 *) &prl->nSuppressed, 0);
+	#elif defined(__clang__) || defined(__GNUC__)
+		return __atomic_exchange_n (&prl->nSuppressed, 0, __ATOMIC_RELAXED);
+	#else
+		#error Not supported
+	#endif
+}
+
+/*
+	Adds the bucket prl to the list of buckets of the target put, unless it is in the
+	list already. Called when the bucket suppresses an event.
+*/
+static void cunilogRateLimitRegister (CUNILOG_TARGET *put, CUNILOG_RATELIMIT *prl)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(prl);
+
+	#if defined (_MSC_VER)
+		if (InterlockedExchange ((volatile LONG *) &prl->bRegistered, 1))
+			return;
+		CUNILOG_RATELIMIT *pHead;
+		do
+		{
+			pHead		= put->prlBuckets;
+			prl->pNext	= pHead;
+		} while	(
+					pHead != InterlockedCompareExchangePointer	(
+								(PVOID volatile *) &put->prlBuckets, prl, pHead
+																)
+				);
+	#elif defined(__clang__) || defined(__GNUC__)
+		if (__atomic_exchange_n (&prl->bRegistered, 1, __ATOMIC_ACQUIRE))
+			return;
+		CUNILOG_RATELIMIT *pHead = __atomic_load_n (&put->prlBuckets, __ATOMIC_RELAXED);
+		do
+		{
+			prl->pNext = pHead;
+		} while	(
+					!__atomic_compare_exchange_n	(
+						&put->prlBuckets, &pHead, prl, false,
+						__ATOMIC_RELEASE, __ATOMIC_RELAXED
+													)
+				);
+	#else
+		#error Not supported
+	#endif
+}
+
+/*
+	Logs the pending counts of all buckets of the target put that have suppressed events
+	since their last report. Called before the target is shut down.
+*/
+static void cunilogRateLimitReportPending (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#if defined (_MSC_VER)
+		CUNILOG_RATELIMIT *prl = InterlockedCompareExchangePointer	(
+									(PVOID volatile *) &put->prlBuckets, NULL, NULL
+																	);
+	#elif defined(__clang__) || defined(__GNUC__)
+		CUNILOG_RATELIMIT *prl = __atomic_load_n (&put->prlBuckets, __ATOMIC_ACQUIRE);
+	#else
+		#error Not supported
+	#endif
+	while (prl)
+	{
+		uint64_t nSuppressed = cunilogRateLimitTakeSuppressed (prl);
+		if (nSuppressed)
+			logTextU8sfmtsev (put, prl->sev, "Suppressed %" PRIu64 " similar events.", nSuppressed);
+		prl = prl->pNext;
+	}
+}
+
+/*
+	Removes all buckets from the list of the target put. The buckets are usually static
+	and can then be used with a new target.
+*/
+static void cunilogRateLimitUnregisterAll (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	CUNILOG_RATELIMIT *prl = put->prlBuckets;
+	CUNILOG_RATELIMIT *nxt;
+	put->prlBuckets = NULL;
+	while (prl)
+	{
+		nxt					= prl->pNext;
+		prl->pNext			= NULL;
+		prl->bRegistered	= 0;
+		prl					= nxt;
+	}
+}
+
+bool cunilogRateLimitPass	(
+		CUNILOG_TARGET				*put,
+		CUNILOG_RATELIMIT			*prl,
+		cueventseverity				sev,
+		uint32_t					uiPerSecond,
+		uint32_t					uiBurst
+							)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(prl);
+	ubf_assert_non_0	(uiPerSecond);
+	ubf_assert_non_0	(uiBurst);
+
+	// FILETIME ticks of 100 ns per second.
+	#define CUNILOG_RATELIMIT_TICKS_PER_SEC	(10000000)
+	ubf_assert (CUNILOG_RATELIMIT_TICKS_PER_SEC >= uiPerSecond);
+
+	uint64_t	uiNow		= GetSystemTimeAsULONGLONGrel ();
+	uint64_t	uiInterval	= CUNILOG_RATELIMIT_TICKS_PER_SEC / uiPerSecond;
+	uint64_t	uiTolerance	= uiInterval * uiBurst;
+	uint64_t	uiTAT		= cunilogRateLimitLoad (&prl->uiTAT);
+	uint64_t	uiNew;
+	bool		bPass;
+
+	// Each event moves the time at which the bucket is full again by one interval.
+	//	The event passes if this time is no more than uiBurst intervals ahead. A
+	//	zero-initialised bucket is therefore full.
+	do
+	{
+		uiNew = (uiTAT > uiNow ? uiTAT : uiNow) + uiInterval;
+		bPass = uiNew - uiNow <= uiTolerance;
+	} while (bPass && !cunilogRateLimitCAS (&prl->uiTAT, &uiTAT, uiNew));
+
+	if (bPass)
+	{
+		uint64_t nSuppressed = cunilogRateLimitTakeSuppressed (prl);
+		if (nSuppressed)
+			logTextU8sfmtsev (put, sev, "Suppressed %" PRIu64 " similar events.", nSuppressed);
+	} else
+	{
+		#if defined (_MSC_VER)
+			InterlockedIncrement64 ((volatile LONG64 *) &prl->nSuppressed);
+		#elif defined(__clang__) || defined(__GNUC__)
+			__atomic_fetch_add (&prl->nSuppressed, 1, __ATOMIC_RELAXED);
+		#else
+			#error Not supported
+		#endif
+		if (!prl->bRegistered)
+		{
+			prl->sev = sev;
+			cunilogRateLimitRegister (put, prl);
+		}
+	}
+	return bPass;
+}
+
+bool logTextU8sevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
+		return true;
 
-#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	void PauseLogCUNILOG_TARGET (CUNILOG_TARGET *put)
-	{
-		ubf_assert_non_NULL (put);
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
+	return pev && cunilogProcessOrQueueEvent (pev);
+}
 
-		EnterCUNILOG_LOCKER (put);
-		cunilogTargetSetIsPaused (put);
-		LeaveCUNILOG_LOCKER (put);
-	}
-#endif
+bool logTextU8sevv			(CUNILOG_TARGET *put, cueventseverity sev, const CUNILOG_FRAGMENT *pfr, size_t nfr)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
 
-#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	size_t ResumeLogCUNILOG_TARGET (CUNILOG_TARGET *put)
-	{
-		ubf_assert_non_NULL (put);
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
+		return true;
 
-		size_t n;
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextV (put, sev, pfr, nfr);
+	return pev && cunilogProcessOrQueueEvent (pev);
+}
 
-		EnterCUNILOG_LOCKER (put);
-		cunilogTargetClrIsPaused (put);
-		n = put->nPausedEvents;
-		put->nPausedEvents = 0;
-		LeaveCUNILOG_LOCKER (put);
+bool logTextU8v				(CUNILOG_TARGET *put, const CUNILOG_FRAGMENT *pfr, size_t nfr)
+{
+	return logTextU8sevv (put, cunilogEvtSeverityNone, pfr, nfr);
+}
 
-		if (needsOrHasLocker (put))
-			triggerCUNILOG_EVENTloggingThread (put, n);
-		return n;
-	}
-#endif
+bool logTextU8sevargs		(CUNILOG_TARGET *put, cueventseverity sev, const CUNILOG_ARG *pa, size_t na)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
 
-/*
-	User logging functions.
-*/
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
+		return true;
 
-bool logEv (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Args (put, sev, pa, na);
+	return pev && cunilogProcessOrQueueEvent (pev);
+}
+
+bool logTextU8sevfields		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccMsg, size_t lenMsg, const CUNILOG_FIELD *pf, size_t nf)
 {
 	ubf_assert_non_NULL	(put);
 	ubf_assert_pvoid	(put);
 	ubf_assert			(cunilogIsTargetInitialised (put));
-	ubf_assert_non_NULL (pev);
-
-	bool bRet;
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
-	{
-		bRet = false;
-		goto discardPev;
-	}
-	if (!isSeverityEnabledCUNILOG_TARGET (pev->evSeverity, put))
-	{
-		bRet = true;
-		goto discardPev;
-	}
-
-	pev->pCUNILOG_TARGET = put;
-	return cunilogProcessOrQueueEvent (pev);
+		return false;
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
+		return true;
 
-	discardPev:
-	DoneCUNILOG_EVENT (put, pev);
-	return bRet;
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Fields (put, sev, ccMsg, lenMsg, pf, nf);
+	return pev && cunilogProcessOrQueueEvent (pev);
 }
 
-bool logTextU8sevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len)
+bool logTextU8sevlref		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len)
 {
 	ubf_assert_non_NULL	(put);
 	ubf_assert_pvoid	(put);
@@ -6493,13 +9877,33 @@ bool logTextU8sevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccTe
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
 		return true;
 
-	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextRef (put, sev, ccText, len);
 	return pev && cunilogProcessOrQueueEvent (pev);
 }
 
+bool logTextU8sevlrefq		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
+		return true;
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextRef (put, sev, ccText, len);
+	if (pev)
+	{
+		cunilogSetEventNoRotation (pev);
+		return cunilogProcessOrQueueEvent (pev);
+	}
+	return false;
+}
+
 bool logTextU8sevlts		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len, UBF_TIMESTAMP ts)
 {
 	ubf_assert_non_NULL	(put);
@@ -6508,7 +9912,7 @@ bool logTextU8sevlts		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, ccText, len, ts);
@@ -6523,7 +9927,7 @@ bool logTextU8sevlq			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
@@ -6543,7 +9947,7 @@ bool logTextU8sevlqts		(CUNILOG_TARGET *put, cueventseverity sev, const char *cc
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, ccText, len, ts);
@@ -6581,7 +9985,7 @@ bool logTextU8l				(CUNILOG_TARGET *put, const char *ccText, size_t len)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, ccText, len);
@@ -6596,7 +10000,7 @@ bool logTextU8lts			(CUNILOG_TARGET *put, const char *ccText, size_t len, UBF_TI
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, cunilogEvtSeverityNone, ccText, len, ts);
@@ -6611,7 +10015,7 @@ bool logTextU8lq			(CUNILOG_TARGET *put, const char *ccText, size_t len)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, ccText, len);
@@ -6631,7 +10035,7 @@ bool logTextU8lqts			(CUNILOG_TARGET *put, const char *ccText, size_t len, UBF_T
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, cunilogEvtSeverityNone, ccText, len, ts);
@@ -6905,6 +10309,79 @@ bool logTextU8sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fm
 	return b;
 }
 
+bool logTextU8sevlkey		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccKey, size_t lenKey, const char *ccText, size_t len)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if	(
+				!isSeverityEnabledCUNILOG_TARGET (sev, put)
+			||	!isKeySampledCUNILOG_TARGET (sev, put, ccKey, lenKey)
+		)
+		return true;
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
+	return pev && cunilogProcessOrQueueEvent (pev);
+}
+
+bool logTextU8svfmtsevkey	(CUNILOG_TARGET *put, cueventseverity sev, const char *ccKey, size_t lenKey, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if	(
+				!isSeverityEnabledCUNILOG_TARGET (sev, put)
+			||	!isKeySampledCUNILOG_TARGET (sev, put, ccKey, lenKey)
+		)
+		return true;
+
+	size_t		l;
+
+	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
+	char		*ob;
+
+	// The argument list is consumed twice.
+	va_list		ap2;
+	va_copy (ap2, ap);
+	l = (size_t) vsnprintf (NULL, 0, fmt, ap2);
+	va_end (ap2);
+
+	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
+	if (ob)
+	{
+		vsnprintf (ob, l + 1, fmt, ap);
+
+		// Not logTextU8sevl (), which would sample the event again.
+		CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ob, l);
+		bool b = pev && cunilogProcessOrQueueEvent (pev);
+		if (ob != cb) ubf_free (ob);
+		return b;
+	}
+	return false;
+}
+
+bool logTextU8sfmtsevkey	(CUNILOG_TARGET *put, cueventseverity sev, const char *ccKey, size_t lenKey, const char *fmt, ...)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_pvoid	(put);
+	ubf_assert			(cunilogIsTargetInitialised (put));
+
+	va_list		ap;
+	bool		b;
+
+	va_start (ap, fmt);
+	b = logTextU8svfmtsevkey (put, sev, ccKey, lenKey, fmt, ap);
+	va_end (ap);
+
+	return b;
+}
+
 bool logTextU8smbvfmtsev	(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev, const char *fmt, va_list ap)
 {
 	ubf_assert_non_NULL	(put);
@@ -7001,7 +10478,7 @@ bool logHexDumpU8sevl		(CUNILOG_TARGET *put, cueventseverity sev, const void *pB
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (sev, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (sev, put) || !isEventSampledCUNILOG_TARGET (sev, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data (put, sev, pBlob, size, ccCaption, lenCaption);
@@ -7016,7 +10493,7 @@ bool logHexDumpU8l			(CUNILOG_TARGET *put, const void *pBlob, size_t size, const
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
@@ -7034,7 +10511,7 @@ bool logHexDump				(CUNILOG_TARGET *put, const void *pBlob, size_t size)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
@@ -7052,7 +10529,7 @@ bool logHexDumpq			(CUNILOG_TARGET *put, const void *pBlob, size_t size)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
-	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
+	if (!isSeverityEnabledCUNILOG_TARGET (cunilogEvtSeverityNone, put) || !isEventSampledCUNILOG_TARGET (cunilogEvtSeverityNone, put))
 		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
@@ -7702,6 +11179,22 @@ bool logEmptyLine			(CUNILOG_TARGET *put)
 	}
 #endif
 
+#ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
+	bool ChangeCUNILOG_TARGETrescanLogfiles (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+
+		enum cunilogEvtCmd	cmd		= cunilogCmdConfigRescanLogfiles;
+		CUNILOG_EVENT		*pev	= CreateCUNILOG_EVENTforCommand (put, cmd);
+		if (pev)
+		{
+			memcpy (pev->szDataToLog, &cmd, sizeof (cmd));
+			return cunilogProcessOrQueueEvent (pev);
+		}
+		return false;
+	}
+#endif
+
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_SEVERITY_TYPE
 	bool ChangeCUNILOG_TARGETeventSeverityFormat (CUNILOG_TARGET *put, cueventseverityformat sevfmt)
@@ -8078,6 +11571,84 @@ void DoneCunilog ()
 }
 
 #ifdef CUNILOG_BUILD_TEST_FNCTS
+	#define CUNILOG_TEST_STAMP(y, m, d, h, mi)				\
+		(		SET_UBF_TIMESTAMP_YEAR_BITS		(y)			\
+			|	SET_UBF_TIMESTAMP_MONTH_BITS	(m)			\
+			|	SET_UBF_TIMESTAMP_DAY_BITS		(d)			\
+			|	SET_UBF_TIMESTAMP_HOUR_BITS		(h)			\
+			|	SET_UBF_TIMESTAMP_MINUTE_BITS	(mi)		\
+		)
+
+	// Custom processor that counts its invocations in the unsigned int pCust points to.
+	static bool cunilogTestCountingProcessor (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (cup);
+		UNUSED (pev);
+
+		CUNILOG_CUSTPROCESS *pcu = cup->pData;
+		++ *(unsigned int *) pcu->pCust;
+		return true;
+	}
+
+	static bool cunilogTestLogAt (CUNILOG_TARGET *put, cueventseverity sev, UBF_TIMESTAMP ts)
+	{
+		CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, "Plan", 4, ts);
+		return pev && logEv (put, pev);
+	}
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		/*
+			The pCust data of the batch test. The member nEvents must stay the first one,
+			since cunilogTestCountingProcessor () increments it too.
+		*/
+		typedef struct cunilog_test_batch
+		{
+			unsigned int		nEvents;
+			unsigned int		nCalls;
+			size_t				anLines [2];
+			size_t				nLines;
+			bool				bOk;
+			CUNILOG_TARGET		*put;
+		} CUNILOG_TEST_BATCH;
+
+		static const char *ccTestBatchTexts [] = { "one", "two", "three", "four", "five" };
+
+		/*
+			Batch callback function that checks the event lines of each batch. Its first call
+			queues the second batch and the shutdown event. Since the separate logging thread
+			is still busy with the first batch, it takes all of them from the queue at once.
+		*/
+		static void cunilogTestBatchProcessor	(
+						CUNILOG_PROCESSOR *cup, const CUNILOG_CUSTLINE *pcl, size_t n
+												)
+		{
+			ubf_assert_non_NULL (cup);
+			ubf_assert_non_NULL (pcl);
+
+			CUNILOG_CUSTPROCESS	*pcu = cup->pData;
+			CUNILOG_TEST_BATCH	*ptb = pcu->pCust;
+			size_t				ui;
+
+			if (ptb->nCalls < GET_ARRAY_LEN (ptb->anLines))
+				ptb->anLines [ptb->nCalls] = n;
+			++ ptb->nCalls;
+			for (ui = 0; ui < n; ++ ui)
+			{
+				ptb->bOk &= pcl [ui].lnLine == strlen (pcl [ui].szLine);
+				ptb->bOk &= ptb->nLines < GET_ARRAY_LEN (ccTestBatchTexts);
+				if (ptb->bOk)
+					ptb->bOk &= NULL != strstr (pcl [ui].szLine, ccTestBatchTexts [ptb->nLines]);
+				++ ptb->nLines;
+			}
+			if (1 == ptb->nCalls)
+			{
+				ptb->bOk &= logTextU8sevl (ptb->put, cunilogEvtSeverityInfo, "four", 4);
+				ptb->bOk &= logTextU8sevl (ptb->put, cunilogEvtSeverityInfo, "five", 4);
+				ptb->bOk &= queueShutdownEvent (ptb->put);
+			}
+		}
+	#endif
+
 	bool test_cunilog (void)
 	{
 		CUNILOG_TARGET	*pt;
@@ -8126,6 +11697,100 @@ void DoneCunilog ()
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberMonthly));
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberYearly));
 
+		/*
+			Period boundaries of the postfixes. The end of a period can have a unit that
+			overflows its bits, like minute 60 or day 32. It must still be greater than
+			any stamp of the period and not greater than the first stamp of the next one.
+		*/
+		UBF_TIMESTAMP	uts;
+		uint64_t		uiEnd;
+
+		uts = CUNILOG_TEST_STAMP (2026, 12, 31, 23, 59) | SET_UBF_TIMESTAMP_SECOND_BITS (59);
+		uiEnd = cunilogPostfixPeriodEnd (uts, cunilogPostfixMinute);
+		ubf_expect_bool_AND (bRet, uts < uiEnd);
+		ubf_expect_bool_AND (bRet, uiEnd <= CUNILOG_TEST_STAMP (2027, 1, 1, 0, 0));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 12, 31, 23, 59) == cunilogPostfixPeriodStart (uts, cunilogPostfixMinute));
+		uiEnd = cunilogPostfixPeriodEnd (uts, cunilogPostfixHour);
+		ubf_expect_bool_AND (bRet, uts < uiEnd);
+		ubf_expect_bool_AND (bRet, uiEnd <= CUNILOG_TEST_STAMP (2027, 1, 1, 0, 0));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 12, 31, 23, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixHour));
+		uiEnd = cunilogPostfixPeriodEnd (uts, cunilogPostfixDay);
+		ubf_expect_bool_AND (bRet, uts < uiEnd);
+		ubf_expect_bool_AND (bRet, uiEnd <= CUNILOG_TEST_STAMP (2027, 1, 1, 0, 0));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 12, 31, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixDay));
+		uiEnd = cunilogPostfixPeriodEnd (uts, cunilogPostfixMonth);
+		ubf_expect_bool_AND (bRet, uts < uiEnd);
+		ubf_expect_bool_AND (bRet, uiEnd <= CUNILOG_TEST_STAMP (2027, 1, 1, 0, 0));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 12, 0, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixMonth));
+		uiEnd = cunilogPostfixPeriodEnd (uts, cunilogPostfixYear);
+		ubf_expect_bool_AND (bRet, uts < uiEnd);
+		ubf_expect_bool_AND (bRet, uiEnd <= CUNILOG_TEST_STAMP (2027, 1, 1, 0, 0));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 0, 0, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixYear));
+
+		// Weeks start on Mondays. Thursday 2026-10-29 carries into the next month.
+		uts = CUNILOG_TEST_STAMP (2026, 10, 29, 12, 0);
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 11, 2, 0, 0) == cunilogPostfixPeriodEnd (uts, cunilogPostfixWeek));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 10, 26, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixWeek));
+		// Sunday 2026-11-01 borrows from the previous month.
+		uts = CUNILOG_TEST_STAMP (2026, 11, 1, 12, 0);
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 11, 2, 0, 0) == cunilogPostfixPeriodEnd (uts, cunilogPostfixWeek));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 10, 26, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixWeek));
+		// Wednesday 2026-12-30 carries into the next year, Sunday 2027-01-03 borrows from
+		//	the previous one.
+		uts = CUNILOG_TEST_STAMP (2026, 12, 30, 12, 0);
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2027, 1, 4, 0, 0) == cunilogPostfixPeriodEnd (uts, cunilogPostfixWeek));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 12, 28, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixWeek));
+		uts = CUNILOG_TEST_STAMP (2027, 1, 3, 23, 59);
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2027, 1, 4, 0, 0) == cunilogPostfixPeriodEnd (uts, cunilogPostfixWeek));
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2026, 12, 28, 0, 0) == cunilogPostfixPeriodStart (uts, cunilogPostfixWeek));
+		// A Monday is the start of its own week.
+		uts = CUNILOG_TEST_STAMP (2027, 1, 4, 0, 0);
+		ubf_expect_bool_AND (bRet, CUNILOG_TEST_STAMP (2027, 1, 11, 0, 0) == cunilogPostfixPeriodEnd (uts, cunilogPostfixWeek));
+		ubf_expect_bool_AND (bRet, uts == cunilogPostfixPeriodStart (uts, cunilogPostfixWeek));
+
+		/*
+			Logfiles compressed to ".gz" archives stay in the files list of date/time postfixes.
+		*/
+		CUNILOG_FLS	flsTest;
+		flsTest.chFilename	= "app_2026-10-19.log.gz";
+		flsTest.stFilename	= strlen (flsTest.chFilename) + 1;
+		ubf_expect_bool_AND (bRet, isArchiveInFLS (&flsTest));
+		ubf_expect_bool_AND (bRet, endsLogFileNameWithLogOrArchive (&flsTest));
+		flsTest.chFilename	= "app_2026-10-19.log";
+		flsTest.stFilename	= strlen (flsTest.chFilename) + 1;
+		ubf_expect_bool_AND (bRet, !isArchiveInFLS (&flsTest));
+		ubf_expect_bool_AND (bRet, endsLogFileNameWithLogOrArchive (&flsTest));
+		flsTest.chFilename	= "app_2026-10-19.log.bak";
+		flsTest.stFilename	= strlen (flsTest.chFilename) + 1;
+		ubf_expect_bool_AND (bRet, !isArchiveInFLS (&flsTest));
+		ubf_expect_bool_AND (bRet, !endsLogFileNameWithLogOrArchive (&flsTest));
+		flsTest.chFilename	= ".gz";
+		flsTest.stFilename	= strlen (flsTest.chFilename) + 1;
+		ubf_expect_bool_AND (bRet, !isArchiveInFLS (&flsTest));
+		ubf_expect_bool_AND (bRet, !endsLogFileNameWithLogOrArchive (&flsTest));
+
+		/*
+			The size budget applies to all rotators that move logfiles to the recycle bin or
+			delete them.
+		*/
+		CUNILOG_ROTATION_DATA	rdTrash		= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_TRASH (4);
+		CUNILOG_ROTATION_DATA	rdCompress	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_COMPRESS (2);
+		CUNILOG_ROTATION_DATA	rdDelete1	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE (8);
+		CUNILOG_ROTATION_DATA	rdDelete2	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE (16);
+		CUNILOG_PROCESSOR		cupTrash	= CUNILOG_INIT_DEF_LOGFILESMOVETOTRASH_PROCESSOR (&rdTrash);
+		CUNILOG_PROCESSOR		cupCompress	= CUNILOG_INIT_DEF_LOGFILESFSCOMPRESS_PROCESSOR (&rdCompress);
+		CUNILOG_PROCESSOR		cupDelete1	= CUNILOG_INIT_DEF_LOGFILESMOVETOTRASH_PROCESSOR (&rdDelete1);
+		CUNILOG_PROCESSOR		cupDelete2	= CUNILOG_INIT_DEF_LOGFILESMOVETOTRASH_PROCESSOR (&rdDelete2);
+		CUNILOG_PROCESSOR		*acupBudget []	=
+			{
+				&cupTrash, &cupCompress, &cupDelete1, &cupDelete2
+			};
+		ConfigCUNILOG_PROCESSORmaxTotalSize (acupBudget, GET_ARRAY_LEN (acupBudget), 4096);
+		ubf_expect_bool_AND (bRet, 4096 == rdTrash.uiMaxTotalSize);
+		ubf_expect_bool_AND (bRet, 0 == rdCompress.uiMaxTotalSize);
+		ubf_expect_bool_AND (bRet, 4096 == rdDelete1.uiMaxTotalSize);
+		ubf_expect_bool_AND (bRet, 4096 == rdDelete2.uiMaxTotalSize);
+
 		/*
 			Check consistency between unilogstruct.h and the declarations in this code file.
 		*/
@@ -8956,6 +12621,299 @@ void DoneCunilog ()
 		ubf_assert_true (bRet);
 		ubf_expect_bool_AND (bRet, !memcmp (put->mbLogEventLine.buf.pcc + st, "123\r\n", 6));
 		DoneCUNILOG_EVENT (put, pev);
+
+		CUNILOG_FRAGMENT afr [] =
+		{
+			{ "GET",	USE_STRLEN	},
+			{ " /",		2			},
+			{ "x\n",	2			}
+		};
+		pev = CreateCUNILOG_EVENT_TextV (put, cunilogEvtSeverityNone, afr, GET_ARRAY_LEN (afr));
+		ubf_expect_bool_AND (bRet, NULL != pev);
+		ubf_expect_bool_AND (bRet, 6 == pev->lenDataToLog);
+		ubf_expect_bool_AND (bRet, !memcmp (pev->szDataToLog, "GET /x", 6));
+
+		// Shared events outlive the event that owns their data.
+		CUNILOG_EVENT *pes1 = cunilogShareCUNILOG_EVENT (pev);
+		CUNILOG_EVENT *pes2 = cunilogShareCUNILOG_EVENT (pes1);
+		ubf_expect_bool_AND (bRet, NULL != pes1 && NULL != pes2);
+		ubf_expect_bool_AND (bRet, pev->szDataToLog == pes1->szDataToLog);
+		ubf_expect_bool_AND (bRet, pev == pes2->pevOwner);
+		ubf_expect_bool_AND (bRet, 2 == pev->nRefs);
+		eventLineSize = createEventLineFromCUNILOG_EVENT (pev);
+		cunilogCacheEventLine (pev);
+		ubf_expect_bool_AND (bRet, NULL != pev->plc);
+		put->mbLogEventLine.buf.pch [0] = ASCII_NUL;
+		ubf_expect_bool_AND (bRet, eventLineSize == createEventLineFromCUNILOG_EVENT (pes1));
+		ubf_expect_bool_AND (bRet, !memcmp (put->mbLogEventLine.buf.pcc + st, "GET /x", 7));
+		DoneCUNILOG_EVENT (put, pev);
+		ubf_expect_bool_AND (bRet, !memcmp (pes1->szDataToLog, "GET /x", 6));
+		DoneCUNILOG_EVENT (put, pes1);
+		ubf_expect_bool_AND (bRet, !memcmp (pes2->szDataToLog, "GET /x", 6));
+		DoneCUNILOG_EVENT (put, pes2);
+
+		/*
+			A target that discards a shared event, here because of its severity mask, releases
+			the event's reference to the data of the event it shares.
+		*/
+		CUNILOG_TARGET		cutDst;
+		CUNILOG_TARGET		cutSrc;
+		CUNILOG_PROCESSOR	cupNoOp		=
+			{
+				cunilogProcessNoOperation, cunilogProcessAppliesTo_nAlways, 0, 0,
+				NULL, OPT_CUNPROC_NONE, 0, NULL
+			};
+		CUNILOG_PROCESSOR	cupFork		=
+			{
+				cunilogProcessTargetFork, cunilogProcessAppliesTo_nAlways, 0, 0,
+				&cutDst, OPT_CUNPROC_NONE, 0, NULL
+			};
+		CUNILOG_PROCESSOR	*acupDst []	= { &cupNoOp };
+		CUNILOG_PROCESSOR	*acupSrc []	= { &cupFork };
+		pt = InitCUNILOG_TARGETex	(
+				&cutDst, "temp", 4, "forkdst", 7,
+				cunilogPath_relativeToExecutable, cunilogSingleThreaded, cunilogPostfixDay,
+				acupDst, GET_ARRAY_LEN (acupDst),
+				cunilogEvtTS_Default, cunilogNewLineSystem, cunilogDontRunProcessorsOnStartup
+									);
+		ubf_expect_bool_AND (bRet, &cutDst == pt);
+		pt = InitCUNILOG_TARGETex	(
+				&cutSrc, "temp", 4, "forksrc", 7,
+				cunilogPath_relativeToExecutable, cunilogSingleThreaded, cunilogPostfixDay,
+				acupSrc, GET_ARRAY_LEN (acupSrc),
+				cunilogEvtTS_Default, cunilogNewLineSystem, cunilogDontRunProcessorsOnStartup
+									);
+		ubf_expect_bool_AND (bRet, &cutSrc == pt);
+		ConfigCUNILOG_TARGETeventSeverityMask (&cutSrc, ~ (evtsevmask_t) 0);
+		pev = CreateCUNILOG_EVENT_Text (&cutSrc, cunilogEvtSeverityDebug, "Debug", 5);
+		pes1 = cunilogShareCUNILOG_EVENT (pev);
+		ubf_expect_bool_AND (bRet, NULL != pes1);
+		ubf_expect_bool_AND (bRet, 1 == pev->nRefs);
+		ubf_expect_bool_AND (bRet, logEv (&cutDst, pes1));
+		ubf_expect_bool_AND (bRet, 0 == pev->nRefs);
+		DoneCUNILOG_EVENT (&cutSrc, pev);
+		// The same through the fork processor, which discards the shared events.
+		unsigned int uiFork;
+		for (uiFork = 0; uiFork < 10; ++ uiFork)
+			ubf_expect_bool_AND (bRet, logTextU8sev (&cutSrc, cunilogEvtSeverityDebug, "Debug"));
+		DoneCUNILOG_TARGET (&cutSrc);
+
+		/*
+			An event that is out of order by one period, like when two threads race to enqueue
+			at midnight, stays in the current logfile. Only a stamp before the previous period
+			means the clock has been set back. Setting uiOpenPeriodEnd is what
+			cunilogOpenLogFile () does.
+		*/
+		pev = CreateCUNILOG_EVENT_Text (&cutDst, cunilogEvtSeverityNone, "Period", 6);
+		ubf_expect_bool_AND (bRet, NULL != pev);
+		pev->stamp = CUNILOG_TEST_STAMP (2026, 10, 31, 23, 59);
+		updatePostfixPeriod (pev);
+		ubf_expect_bool_AND (bRet, !memcmp (cutDst.szDateTimeStamp, "2026-10-31", LEN_ISO8601DATE));
+		ubf_expect_bool_AND (bRet, requiresNewLogFile (&cutDst));
+		cutDst.uiOpenPeriodEnd = cutDst.uiPostfixPeriodEnd;
+		pev->stamp = CUNILOG_TEST_STAMP (2026, 11, 1, 0, 0);
+		updatePostfixPeriod (pev);
+		ubf_expect_bool_AND (bRet, !memcmp (cutDst.szDateTimeStamp, "2026-11-01", LEN_ISO8601DATE));
+		ubf_expect_bool_AND (bRet, requiresNewLogFile (&cutDst));
+		cutDst.uiOpenPeriodEnd = cutDst.uiPostfixPeriodEnd;
+		pev->stamp = CUNILOG_TEST_STAMP (2026, 10, 31, 23, 59);
+		updatePostfixPeriod (pev);
+		ubf_expect_bool_AND (bRet, !memcmp (cutDst.szDateTimeStamp, "2026-11-01", LEN_ISO8601DATE));
+		ubf_expect_bool_AND (bRet, !requiresNewLogFile (&cutDst));
+		pev->stamp = CUNILOG_TEST_STAMP (2026, 11, 1, 0, 1);
+		updatePostfixPeriod (pev);
+		ubf_expect_bool_AND (bRet, !requiresNewLogFile (&cutDst));
+		// Clock set back by more than one period.
+		pev->stamp = CUNILOG_TEST_STAMP (2026, 10, 30, 12, 0);
+		updatePostfixPeriod (pev);
+		ubf_expect_bool_AND (bRet, !memcmp (cutDst.szDateTimeStamp, "2026-10-30", LEN_ISO8601DATE));
+		ubf_expect_bool_AND (bRet, requiresNewLogFile (&cutDst));
+		cutDst.uiOpenPeriodEnd = cutDst.uiPostfixPeriodEnd;
+		ubf_expect_bool_AND (bRet, !requiresNewLogFile (&cutDst));
+		DoneCUNILOG_EVENT (&cutDst, pev);
+
+		/*
+			The execution plan of the processors. A processor with a time-based frequency is
+			skipped before its deadline and runs again when the period changes.
+		*/
+		unsigned int		nMinute		= 0;
+		unsigned int		nAlways		= 0;
+		CUNILOG_CUSTPROCESS	cpMinute	=
+			CUNILOG_INIT_DEF_CUSTPROCESS (&nMinute, cunilogTestCountingProcessor, NULL);
+		CUNILOG_CUSTPROCESS	cpAlways	=
+			CUNILOG_INIT_DEF_CUSTPROCESS (&nAlways, cunilogTestCountingProcessor, NULL);
+		CUNILOG_PROCESSOR	cupMinute	=
+			{
+				cunilogProcessCustomProcessor, cunilogProcessAppliesTo_MinuteChanged, 0, 0,
+				&cpMinute, OPT_CUNPROC_FORCE_NEXT, 0, NULL
+			};
+		CUNILOG_PROCESSOR	cupAlways	=
+			{
+				cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+				&cpAlways, OPT_CUNPROC_NONE, 0, NULL
+			};
+		CUNILOG_PROCESSOR	*acupPlan []	= { &cupMinute, &cupAlways };
+		CUNILOG_TARGET		cutPlan;
+		pt = InitCUNILOG_TARGETex	(
+				&cutPlan, "temp", 4, "plan", 4,
+				cunilogPath_relativeToExecutable, cunilogSingleThreaded, cunilogPostfixDay,
+				acupPlan, GET_ARRAY_LEN (acupPlan),
+				cunilogEvtTS_Default, cunilogNewLineSystem, cunilogDontRunProcessorsOnStartup
+									);
+		ubf_expect_bool_AND (bRet, &cutPlan == pt);
+		ConfigCUNILOG_TARGETeventSeverityMask (&cutPlan, ~ (evtsevmask_t) 0);
+		uts = CUNILOG_TEST_STAMP (2026, 10, 19, 12, 0);
+		// The first event only sets the threshold.
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (10)));
+		ubf_expect_bool_AND (bRet, 2 == cutPlan.nplan);
+		ubf_expect_bool_AND (bRet, 0 == nMinute);
+		ubf_expect_bool_AND (bRet, 1 == nAlways);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (59)));
+		ubf_expect_bool_AND (bRet, 0 == nMinute);
+		ubf_expect_bool_AND (bRet, 2 == nAlways);
+		uts = CUNILOG_TEST_STAMP (2026, 10, 19, 12, 1);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts));
+		ubf_expect_bool_AND (bRet, 1 == nMinute);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (30)));
+		ubf_expect_bool_AND (bRet, 1 == nMinute);
+		ubf_expect_bool_AND (bRet, 4 == nAlways);
+
+		// OPT_CUNPROC_AT_STARTUP runs the processor before its deadline, but only once.
+		cupMinute.uiOpts |= OPT_CUNPROC_AT_STARTUP;
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (40)));
+		ubf_expect_bool_AND (bRet, 2 == nMinute);
+		ubf_expect_bool_AND (bRet, !optCunProcHasOPT_CUNPROC_AT_STARTUP (cupMinute.uiOpts));
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (50)));
+		ubf_expect_bool_AND (bRet, 2 == nMinute);
+		ubf_expect_bool_AND (bRet, 6 == nAlways);
+
+		// The severity mask of the processor.
+		ConfigCUNILOG_PROCESSORdisableEventSeverity (&cupAlways, cunilogEvtSeverityDebug);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityDebug, uts | SET_UBF_TIMESTAMP_SECOND_BITS (51)));
+		ubf_expect_bool_AND (bRet, 6 == nAlways);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (52)));
+		ubf_expect_bool_AND (bRet, 7 == nAlways);
+
+		// Disabled processors drop out of the plan and come back when they're enabled.
+		ConfigCUNILOG_TARGETdisableTaskProcessors (&cutPlan, cunilogProcessCustomProcessor);
+		uts = CUNILOG_TEST_STAMP (2026, 10, 19, 12, 2);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts));
+		ubf_expect_bool_AND (bRet, 0 == cutPlan.nplan);
+		ubf_expect_bool_AND (bRet, 2 == nMinute);
+		ubf_expect_bool_AND (bRet, 7 == nAlways);
+		ConfigCUNILOG_TARGETenableTaskProcessors (&cutPlan, cunilogProcessCustomProcessor);
+		uts = CUNILOG_TEST_STAMP (2026, 10, 19, 12, 3);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts));
+		ubf_expect_bool_AND (bRet, 2 == cutPlan.nplan);
+		ubf_expect_bool_AND (bRet, 3 == nMinute);
+		ubf_expect_bool_AND (bRet, 8 == nAlways);
+
+		// OPT_CUNPROC_DISABLED set directly takes effect without a new plan. Clearing it
+		//	directly requires ConfigCUNILOG_TARGETprocessorsChanged ().
+		optCunProcSetOPT_CUNPROC_DISABLED (cupAlways.uiOpts);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (10)));
+		ubf_expect_bool_AND (bRet, 8 == nAlways);
+		ConfigCUNILOG_TARGETprocessorsChanged (&cutPlan);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (20)));
+		ubf_expect_bool_AND (bRet, 1 == cutPlan.nplan);
+		ubf_expect_bool_AND (bRet, 8 == nAlways);
+		optCunProcClrOPT_CUNPROC_DISABLED (cupAlways.uiOpts);
+		ConfigCUNILOG_TARGETprocessorsChanged (&cutPlan);
+		ubf_expect_bool_AND (bRet, cunilogTestLogAt (&cutPlan, cunilogEvtSeverityInfo, uts | SET_UBF_TIMESTAMP_SECOND_BITS (30)));
+		ubf_expect_bool_AND (bRet, 2 == cutPlan.nplan);
+		ubf_expect_bool_AND (bRet, 9 == nAlways);
+		ubf_expect_bool_AND (bRet, 3 == nMinute);
+		DoneCUNILOG_TARGET (&cutPlan);
+		DoneCUNILOG_TARGET (&cutDst);
+
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			/*
+				A batch callback function is only called with OPT_CUNPROC_BATCH. The separate
+				logging thread hands it the lines of each batch it takes from the queue, and the
+				shutdown event the lines that are still pending.
+			*/
+			CUNILOG_TEST_BATCH	tb			= { 0, 0, { 0, 0 }, 0, true, NULL };
+			CUNILOG_CUSTPROCESS	cpBatch		=
+				CUNILOG_INIT_DEF_CUSTPROCESS_BATCH (&tb, cunilogTestBatchProcessor, NULL);
+			CUNILOG_CUSTPROCESS	cpNoBatch	=
+				CUNILOG_INIT_DEF_CUSTPROCESS (&tb, cunilogTestCountingProcessor, NULL);
+			cpNoBatch.procBatch = cunilogTestBatchProcessor;
+			CUNILOG_PROCESSOR	cupBatch	=
+				{
+					cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+					&cpBatch, OPT_CUNPROC_BATCH, 0, NULL
+				};
+			CUNILOG_PROCESSOR	cupNoBatch	=
+				{
+					cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+					&cpNoBatch, OPT_CUNPROC_NONE, 0, NULL
+				};
+			CUNILOG_PROCESSOR	*acupBatch []	= { &cupBatch, &cupNoBatch };
+			CUNILOG_TARGET		cutBatch;
+			pt = InitCUNILOG_TARGETex	(
+					&cutBatch, "temp", 4, "batch", 5,
+					cunilogPath_relativeToExecutable, cunilogSingleThreadedSeparateLoggingThread,
+					cunilogPostfixDay, acupBatch, GET_ARRAY_LEN (acupBatch),
+					cunilogEvtTS_Default, cunilogNewLineSystem, cunilogDontRunProcessorsOnStartup
+										);
+			ubf_expect_bool_AND (bRet, &cutBatch == pt);
+			ConfigCUNILOG_TARGETeventSeverityMask (&cutBatch, ~ (evtsevmask_t) 0);
+			tb.put = &cutBatch;
+			// The paused events end up in the first batch. Events logged to a paused target
+			//	don't trigger the separate logging thread, hence their return value is false.
+			PauseLogCUNILOG_TARGET (&cutBatch);
+			logTextU8sevl (&cutBatch, cunilogEvtSeverityInfo, "one", 3);
+			logTextU8sevl (&cutBatch, cunilogEvtSeverityInfo, "two", 3);
+			logTextU8sevl (&cutBatch, cunilogEvtSeverityInfo, "three", 5);
+			ubf_expect_bool_AND (bRet, 3 == ResumeLogCUNILOG_TARGET (&cutBatch));
+			// The shutdown event has been queued by the callback function.
+			WaitForEndOfSeparateLoggingThread (&cutBatch);
+			cunilogTargetSetShutdownCompleteFlag (&cutBatch);
+			ubf_expect_bool_AND (bRet, tb.bOk);
+			ubf_expect_bool_AND (bRet, 2 == tb.nCalls);
+			ubf_expect_bool_AND (bRet, 3 == tb.anLines [0]);
+			ubf_expect_bool_AND (bRet, 2 == tb.anLines [1]);
+			ubf_expect_bool_AND (bRet, 5 == tb.nLines);
+			ubf_expect_bool_AND (bRet, 5 == tb.nEvents);
+			DoneCUNILOG_TARGET (&cutBatch);
+		#endif
+
+		CUNILOG_ARG aa [] =
+		{
+			cunilogArgStr ("a="),	cunilogArgI64 (-12),
+			cunilogArgStr (" b="),	cunilogArgU64 (34),
+			cunilogArgStr (" c="),	cunilogArgHex (0xAB),
+			cunilogArgStr (" d="),	cunilogArgFltd (-2.5, 2),
+			cunilogArgStr (" e="),	cunilogArgFltd (0.9999, 2)
+		};
+		pev = CreateCUNILOG_EVENT_Args (put, cunilogEvtSeverityNone, aa, GET_ARRAY_LEN (aa));
+		ubf_expect_bool_AND (bRet, NULL != pev);
+		const char *szExp = "a=-12 b=34 c=00000000000000AB d=-2.50 e=1.00";
+		ubf_expect_bool_AND (bRet, strlen (szExp) == pev->lenDataToLog);
+		ubf_expect_bool_AND (bRet, !memcmp (pev->szDataToLog, szExp, strlen (szExp)));
+		DoneCUNILOG_EVENT (put, pev);
+
+		CUNILOG_FIELD af [] =
+		{
+			cunilogField ("path",	cunilogArgStr ("/a\"b")),
+			cunilogField ("status",	cunilogArgI64 (200)),
+			cunilogField ("secs",	cunilogArgFltd (0.25, 2))
+		};
+		pev = CreateCUNILOG_EVENT_Fields (put, cunilogEvtSeverityInfo, "Req", 3, af, GET_ARRAY_LEN (af));
+		ubf_expect_bool_AND (bRet, NULL != pev);
+		ubf_expect_bool_AND (bRet, 3 == pev->lenDataToLog);
+		eventLineSize = createEventLineFromCUNILOG_EVENT (pev);
+		st = requiredEvtLineTimestampAndSeverityLength (pev);
+		szExp = "Req path=/a\"b status=200 secs=0.25";
+		ubf_expect_bool_AND (bRet, st + strlen (szExp) == eventLineSize);
+		ubf_expect_bool_AND (bRet, !memcmp (put->mbLogEventLine.buf.pcc + st, szExp, strlen (szExp) + 1));
+		ln = cunilogJSONLineFromEvent (pev);
+		szExp = "\",\"sev\":\"INFO\",\"msg\":\"Req\",\"path\":\"/a\\\"b\",\"status\":200,\"secs\":0.25}";
+		ubf_expect_bool_AND (bRet, 7 + LEN_ISO8601DATETIMESTAMPMS + strlen (szExp) == ln);
+		ubf_expect_bool_AND (bRet, !memcmp (put->mbJSONLine.buf.pcc, "{\"ts\":\"", 7));
+		ubf_expect_bool_AND (bRet, !memcmp (put->mbJSONLine.buf.pcc + 7 + LEN_ISO8601DATETIMESTAMPMS, szExp, strlen (szExp) + 1));
+		DoneCUNILOG_EVENT (put, pev);
+
 		DoneCUNILOG_TARGET (put);
 
 		return bRet;
@@ -198,13 +198,8 @@ DoneCUNILOG_TARGETstatic ();
 #endif
 
 /*!
-	The default initial size of an event line that contains ANSI colour codes for severity
-	levels plus the event line itself.
-	If you know in advance that your texts (including stamp etc) are going to be longer you
-	may override this with a higher value to possibly save some initial heap reallocations.
-	The default is CUNILOG_INITIAL_EVENTLINE_SIZE.
-
-	This value must be greater than 0.
+	Coloured console output for severity levels writes the ANSI colour codes and the event
+	line separately, without copying the event line.
 
 	If you don't need coloured console output for severity levels you can switch it off by
 	defining CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR or CUNILOG_BUILD_WITHOUT_CONSOLE_COLOR.
@@ -214,13 +209,31 @@ DoneCUNILOG_TARGETstatic ();
 	#define CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
 	#endif
 #endif
-#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-	#ifndef CUNILOG_INITIAL_COLEVENTLINE_SIZE
-	#define CUNILOG_INITIAL_COLEVENTLINE_SIZE		(CUNILOG_INITIAL_EVENTLINE_SIZE)
-	#endif
-	#if CUNILOG_INITIAL_COLEVENTLINE_SIZE <= 0
-		#error CUNILOG_INITIAL_COLEVENTLINE_SIZE must be greater than zero
-	#endif
+
+/*!
+	Buffered console output. See ConfigCUNILOG_TARGETcoutBuffered ().
+
+	CUNILOG_COUT_BUFFER_SIZE is the size of the buffer in octets. A batch is written to
+	stdout when it reaches this size, or when its first line has been in the buffer for
+	CUNILOG_COUT_FLUSH_INTERVAL_MS milliseconds, whatever comes first. The buffer grows
+	for event lines that are longer.
+*/
+#ifndef CUNILOG_COUT_BUFFER_SIZE
+#define CUNILOG_COUT_BUFFER_SIZE				(16384)
+#endif
+#ifndef CUNILOG_COUT_FLUSH_INTERVAL_MS
+#define CUNILOG_COUT_FLUSH_INTERVAL_MS			(200)
+#endif
+
+/*!
+	The size in octets of the bounded buffer of the asynchronous stage of a console output
+	processor with option flag OPT_CUNPROC_ASYNC. Output that does not fit into the buffer
+	anymore is dropped, and a notice with the amount of dropped lines is written once the
+	stage catches up. This means that a blocked or slow stdout never delays the processors
+	that follow, like the one writing to the logfile. The stage allocates twice this size.
+*/
+#ifndef CUNILOG_COUT_ASYNC_SIZE
+#define CUNILOG_COUT_ASYNC_SIZE					(65536)
 #endif
 
 // Literally an arbitray character. This is used to find buffer overruns in debug
@@ -1427,6 +1440,75 @@ TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORnLogFiles)
 )
 ;
 
+/*!
+	ConfigCUNILOG_PROCESSORseverityMask
+	ConfigCUNILOG_PROCESSORdisableEventSeverity
+	ConfigCUNILOG_PROCESSORenableEventSeverity
+
+	Set the severities a single processor processes. The target's severity mask (see
+	ConfigCUNILOG_TARGETeventSeverityMask ()) decides whether an event is created at all.
+	The processor's severity mask then decides whether this processor processes the event.
+	Events with other severities skip the processor and carry on with the next one. This
+	allows, for instance, to echo only warnings and errors to the console while the logfile
+	receives all events of the same target. By default, processors process all severities.
+
+	The bits of sevmask are the same as the ones of the target's severity mask. If a bit is
+	set, the processor processes events with this severity.
+
+	Example:
+
+	ConfigCUNILOG_PROCESSORseverityMask	(
+		pcupCout,
+			((evtsevmask_t) 1 << cunilogEvtSeverityWarning)
+		|	((evtsevmask_t) 1 << cunilogEvtSeverityError)
+		|	((evtsevmask_t) 1 << cunilogEvtSeverityCritical)
+		|	((evtsevmask_t) 1 << cunilogEvtSeverityFatal)
+										);
+
+	The functions are not thread-safe and should be called before the processor's target
+	is used.
+*/
+void ConfigCUNILOG_PROCESSORseverityMask			(CUNILOG_PROCESSOR *cup, evtsevmask_t sevmask);
+void ConfigCUNILOG_PROCESSORdisableEventSeverity	(CUNILOG_PROCESSOR *cup, cueventseverity sev);
+void ConfigCUNILOG_PROCESSORenableEventSeverity		(CUNILOG_PROCESSOR *cup, cueventseverity sev);
+
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORseverityMask)
+	(CUNILOG_PROCESSOR *cup, evtsevmask_t sevmask);
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORdisableEventSeverity)
+	(CUNILOG_PROCESSOR *cup, cueventseverity sev);
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORenableEventSeverity)
+	(CUNILOG_PROCESSOR *cup, cueventseverity sev);
+
+/*!
+	ConfigCUNILOG_PROCESSORmaxTotalSize
+
+	Sets a size budget in octets for all logfiles of the processors' target together. The
+	budget is set for every processor in cuProcessorList that moves logfiles to the
+	recycle bin or deletes them. When a rotation runs, the least recent logfiles that don't fit into the budget anymore
+	are moved to the recycle bin or deleted, in addition to the ones exceeding the amount
+	of logfiles to keep (see ConfigCUNILOG_PROCESSORnLogFiles ()). The current logfile is
+	never removed. A value of 0 switches the size budget off, which is the default.
+
+	The sizes are tracked by the target as logfiles are written, renamed, and removed, and
+	are only obtained from the file system when the logging folder is read. Logfiles
+	count with their logical (uncompressed) size, also when they're compressed by the
+	file system. Logfiles compressed to ".gz" archives count with the size of the archive,
+	apart from dot number postfixes, whose archives are not counted.
+*/
+void ConfigCUNILOG_PROCESSORmaxTotalSize	(
+		CUNILOG_PROCESSOR	**cuProcessorList,					// One or more processors.
+		unsigned int		nProcessors,						// Number of processors.
+		uint64_t			uiMaxTotalSize
+											)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORmaxTotalSize)
+(
+		CUNILOG_PROCESSOR	**cuProcessorList,					// One or more processors.
+		unsigned int		nProcessors,						// Number of processors.
+		uint64_t			uiMaxTotalSize
+)
+;
+
 /*!
 	ConfigCUNILOG_TARGETdisableTaskProcessors
 	ConfigCUNILOG_TARGETenableTaskProcessors
@@ -1441,6 +1523,18 @@ TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETdisableTaskProcessors)
 TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETenableTaskProcessors)
 	(CUNILOG_TARGET *put, enum cunilogprocesstask task);
 
+/*!
+	ConfigCUNILOG_TARGETprocessorsChanged
+
+	Tells the target put that members of its processors have been changed directly, for
+	instance the option flag OPT_CUNPROC_DISABLED in uiOpts, or the frequency. The target
+	rebuilds the execution plan of its processors before the next event. Setting
+	OPT_CUNPROC_DISABLED directly takes effect without calling this function, but clearing
+	it does not.
+*/
+void ConfigCUNILOG_TARGETprocessorsChanged (CUNILOG_TARGET *put);
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETprocessorsChanged) (CUNILOG_TARGET *put);
+
 /*!
 	ConfigCUNILOG_TARGETdisableCoutProcessor
 	ConfigCUNILOG_TARGETenableCoutProcessor
@@ -1454,6 +1548,141 @@ void ConfigCUNILOG_TARGETenableCoutProcessor	(CUNILOG_TARGET *put);
 TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETdisableCoutProcessor)	(CUNILOG_TARGET *put);
 TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETenableCoutProcessor)	(CUNILOG_TARGET *put);
 
+/*!
+	ConfigCUNILOG_TARGETrescanLogfiles
+
+	Discards the target's list of logfiles. The list is read from disk again the next time
+	a rotation processor needs it.
+
+	The target keeps this list in sync with its own renames, compressions, deletions, and
+	new logfiles, and reads it again by itself when the modification time of the logging
+	folder shows that something else has changed the folder. Call this function when such a
+	change cannot be detected this way, for instance on file systems that don't maintain
+	directory modification times.
+
+	The function is not thread-safe. Use ChangeCUNILOG_TARGETrescanLogfiles () for a target
+	that is already in use.
+*/
+void ConfigCUNILOG_TARGETrescanLogfiles (CUNILOG_TARGET *put);
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETrescanLogfiles) (CUNILOG_TARGET *put);
+
+/*!
+	ConfigCUNILOG_TARGETdotNumberMonotonic
+
+	Switches the target's dot number postfix (cunilogPostfixDotNumberMinutely,
+	cunilogPostfixDotNumberHourly, etc.) between the default and the monotonic numbering
+	mode.
+
+	In the default mode, the most recent archived logfile is always "file.log.1". A rotation
+	renames "file.log.<n>" to "file.log.<n + 1>" for every archived logfile, starting with
+	the oldest one, and finally "file.log" to "file.log.1". The cost of a rotation therefore
+	grows with the amount of logfiles kept.
+
+	In monotonic mode, only "file.log" is renamed to "file.log.<n + 1>", with n being the
+	highest number found. The most recent archived logfile has the highest number, and a
+	rotation costs a single rename. Readers should sort the logfiles by number. The
+	compression and retention rotators keep working with the amount of files to ignore
+	in both modes.
+
+	The parameter bMonotonic switches the monotonic mode on (true) or off (false). The
+	function has no effect on targets with other postfixes.
+
+	The function is not thread-safe and should be called before the target is used.
+	The setting is the target option flag CUNILOGTARGET_DOTNUMBER_MONOTONIC.
+*/
+void ConfigCUNILOG_TARGETdotNumberMonotonic (CUNILOG_TARGET *put, bool bMonotonic);
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETdotNumberMonotonic)
+	(CUNILOG_TARGET *put, bool bMonotonic);
+
+/*!
+	ConfigCUNILOG_TARGETcoutBuffered
+
+	Switches buffered console output on (bBuffered true) or off (bBuffered false). By
+	default, each event line is written to stdout with puts (), which can be a write ()
+	system call per event when stdout is a pipe, plus the locking of the standard library.
+	With buffered console output, the console output processor collects the lines in a
+	buffer of the target instead, and writes each batch with a single write () (WriteFile ()
+	on Windows) call. A batch ends when the buffer is full (see CUNILOG_COUT_BUFFER_SIZE),
+	when its first line is older than CUNILOG_COUT_FLUSH_INTERVAL_MS, when the separate
+	logging thread has processed all queued events, and when the target shuts down. Note
+	that a target without a separate logging thread only checks the interval when it
+	processes the next event.
+
+	When a target is initialised, buffered console output is switched on and coloured output
+	switched off if stdout is not a terminal, i.e. if it's redirected to a pipe or a file.
+	Call this function and ConfigCUNILOG_TARGETuseColourForCout () afterwards to override
+	this.
+
+	The function is not thread-safe and should be called before the target is used.
+	The setting is the target option flag CUNILOGTARGET_COUT_BUFFERED.
+*/
+void ConfigCUNILOG_TARGETcoutBuffered (CUNILOG_TARGET *put, bool bBuffered);
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETcoutBuffered)
+	(CUNILOG_TARGET *put, bool bBuffered);
+
+/*!
+	ConfigCUNILOG_TARGETsampling
+
+	Sets the sampling rate for events with severity sev. A value of n for uiOneIn keeps
+	1 in n events of this severity, for instance every 100th debug event. A value of 0 or 1
+	keeps all events, which is the default. The decision is made before an event is
+	created. The logging functions ending in key, like logTextU8sfmtsevkey (), decide by
+	the hash of their sampling key instead, which keeps all events of a key together.
+
+	The function returns false if the memory for the sampling rates could not be
+	allocated. Otherwise it returns true.
+*/
+bool ConfigCUNILOG_TARGETsampling (CUNILOG_TARGET *put, cueventseverity sev, uint32_t uiOneIn);
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETsampling)
+	(CUNILOG_TARGET *put, cueventseverity sev, uint32_t uiOneIn);
+
+/*!
+	ConfigCUNILOG_TARGETloadShedding
+
+	Configures adaptive load shedding for a target with a separate logging thread. The array
+	stages points to nStages CUNILOG_SHED_STAGE structures, each with a queue depth nDepth
+	and a severity mask. When an event is queued and the amount of events waiting for the
+	separate logging thread reaches the depth of a stage, events with the severities in the
+	stage's mask are discarded before they are created, for instance:
+
+	CUNILOG_SHED_STAGE stages [2] =
+	{
+		{10000, (1 << cunilogEvtSeverityDebug) | (1 << cunilogEvtSeverityTrace)
+					| (1 << cunilogEvtSeverityDetail) | (1 << cunilogEvtSeverityVerbose)},
+		{50000, (1 << cunilogEvtSeverityInfo)}
+	};
+	ConfigCUNILOG_TARGETloadShedding (put, 100, 2, stages);
+
+	The severity mask of the target is not changed. When the separate logging thread takes
+	no more than nLowWater events from the queue at once, i.e. it has caught up, shedding
+	ends and a warning with the amount of discarded events is logged.
+
+	A value of 0 for nStages switches load shedding off, which is the default. At most
+	CUNILOG_MAX_SHED_STAGES stages are supported.
+
+	The function returns true on success. It returns false if nStages is greater than
+	CUNILOG_MAX_SHED_STAGES, or if the target doesn't have a separate logging thread.
+
+	The function is not available if CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETloadShedding	(
+			CUNILOG_TARGET				*put,
+			size_t						nLowWater,
+			unsigned int				nStages,
+			const CUNILOG_SHED_STAGE	*stages
+											)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETloadShedding)
+	(
+			CUNILOG_TARGET				*put,
+			size_t						nLowWater,
+			unsigned int				nStages,
+			const CUNILOG_SHED_STAGE	*stages
+	)
+	;
+#endif
+
 /*!
 	ConfigCUNILOG_TARGETeventSeverityMask
 
@@ -1851,6 +2080,114 @@ TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, CreateCUNILOG_EVENT_Text)
 											)
 ;
 
+/*!
+	CreateCUNILOG_EVENT_TextV
+
+	This is the scatter-gather version of CreateCUNILOG_EVENT_Text (). The text of the
+	event consists of the nfr fragments pfr points to, which the function copies directly
+	into the event's allocation. No intermediate buffer is required to concatenate them.
+*/
+CUNILOG_EVENT *CreateCUNILOG_EVENT_TextV	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const CUNILOG_FRAGMENT		*pfr,
+					size_t						nfr
+											)
+;
+TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, CreateCUNILOG_EVENT_TextV)
+											(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const CUNILOG_FRAGMENT		*pfr,
+					size_t						nfr
+											)
+;
+
+/*!
+	CreateCUNILOG_EVENT_Args
+
+	Creates a text event from the na typed arguments pa points to, without using printf ().
+	Integers and hexadecimal values are written with the converters of strintuint.c and
+	strhex.c directly into the event's allocation. The size of the allocation is obtained
+	from the maximum length of each argument's type, which means no separate pass is
+	required to obtain the length of the text.
+*/
+CUNILOG_EVENT *CreateCUNILOG_EVENT_Args	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const CUNILOG_ARG			*pa,
+					size_t						na
+											)
+;
+TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, CreateCUNILOG_EVENT_Args)
+											(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const CUNILOG_ARG			*pa,
+					size_t						na
+											)
+;
+
+/*!
+	CreateCUNILOG_EVENT_Fields
+
+	Creates a structured event of type cunilogEvtTypeFields. The event consists of the
+	message text ccMsg with length lenMsg, which can be USE_STRLEN, and the nf key/value
+	fields pf points to. Keys and values are copied into the event.
+
+	Processors that output event lines render the event as the message followed by
+	" key=value" for each field. Processors with the option flag OPT_CUNPROC_JSON output
+	the event as a JSON line, with each field as a member of the JSON object. See
+	docs/processors.md.
+*/
+CUNILOG_EVENT *CreateCUNILOG_EVENT_Fields	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccMsg,
+					size_t						lenMsg,
+					const CUNILOG_FIELD			*pf,
+					size_t						nf
+											)
+;
+TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, CreateCUNILOG_EVENT_Fields)
+											(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccMsg,
+					size_t						lenMsg,
+					const CUNILOG_FIELD			*pf,
+					size_t						nf
+											)
+;
+
+/*!
+	CreateCUNILOG_EVENT_TextRef
+
+	This function is identical to CreateCUNILOG_EVENT_Text () but does not copy the text.
+	Only the event structure is allocated, and its member szDataToLog points to ccText.
+	The event has the option flag CUNILOGEVENT_DATA_BY_REFERENCE set.
+
+	The text must stay valid and unchanged until the event has been processed, which for
+	targets with a separate logging thread is some time after the function returned. This
+	is guaranteed for string literals and other static text, but normally not for text on
+	the stack or text in buffers that are freed or re-used.
+*/
+CUNILOG_EVENT *CreateCUNILOG_EVENT_TextRef	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccText,
+					size_t						len
+											)
+;
+TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, CreateCUNILOG_EVENT_TextRef)
+											(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccText,
+					size_t						len
+											)
+;
+
 /*!
 	CreateCUNILOG_EVENT_TextTS
 
@@ -1891,11 +2228,31 @@ TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, CreateCUNILOG_EVENT_TextTS)
 CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev);
 TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, DuplicateCUNILOG_EVENT) (CUNILOG_EVENT *pev);
 
+/*!
+	cunilogShareCUNILOG_EVENT
+
+	Creates a new event on the heap that shares the data of the event pev points to
+	instead of copying it. Only the CUNILOG_EVENT structure is allocated. The data is kept
+	alive with a reference count until the last event that refers to it has been destroyed
+	with DoneCUNILOG_EVENT (). This makes it cheap to send the same event to several targets,
+	for instance from the processors cunilogProcessTargetFork and
+	cunilogProcessTargetRedirector. The data must not be changed after it has been shared.
+
+	If the event pev points to has not been allocated on the heap, it cannot be kept alive,
+	and the function falls back to DuplicateCUNILOG_EVENT ().
+
+	The function returns a pointer to the new event, or NULL if it couldn't be allocated.
+*/
+CUNILOG_EVENT *cunilogShareCUNILOG_EVENT (CUNILOG_EVENT *pev);
+TYPEDEF_FNCT_PTR (CUNILOG_EVENT *, cunilogShareCUNILOG_EVENT) (CUNILOG_EVENT *pev);
+
 /*!
 	DoneCUNILOG_EVENT
 
 	Destroys an SUNILOGEVENT structure including all its resources if the event belongs
-	to target put. If put is NULL the event is destroyed regardless.
+	to target put. If put is NULL the event is destroyed regardless. The data of an event
+	that is shared with other events (see cunilogShareCUNILOG_EVENT ()) is only released
+	together with the last one of them.
 
 	The function always returns NULL.
 */
@@ -1995,6 +2352,51 @@ TYPEDEF_FNCT_PTR (bool, logEv) (CUNILOG_TARGET *put, CUNILOG_EVENT *pev);
 	created with cunilogRunProcessorsOnStartup, the quick option is ignored for the first call
 	and the rotation processors are executed regardless.
 
+	The functions logTextU8sevv () and logTextU8v () log a text made up of nfr fragments
+	of type CUNILOG_FRAGMENT. The fragments are copied into the event in a single pass,
+	which avoids concatenating them in a separate buffer first. Example:
+
+	CUNILOG_FRAGMENT afr [] =
+	{
+		{ szMethod,		USE_STRLEN	},
+		{ " ",			1			},
+		{ szPath,		lnPath		}
+	};
+	logTextU8sevv (put, cunilogEvtSeverityInfo, afr, GET_ARRAY_LEN (afr));
+
+	The function logTextU8sevargs () and the macro logTextU8sevt () log a text made up of
+	typed arguments, without a format string and without printf (). See
+	CreateCUNILOG_EVENT_Args (). Each argument is created with cunilogArg (), which selects
+	the type from the type of its parameter if the compiler supports C11, or one of the
+	cunilogArg... () functions. Example:
+
+	logTextU8sevt	(
+		put, cunilogEvtSeverityInfo,
+		cunilogArg ("Status "), cunilogArg (iStatus),
+		cunilogArg (", took "), cunilogArgFltd (dSecs, 3), cunilogArg (" s, flags "),
+		cunilogArgHex (uiFlags)
+					);
+
+	The function logTextU8sevfields () and the macro logTextU8sevkv () log a structured
+	event with key/value fields. See CreateCUNILOG_EVENT_Fields (). Example:
+
+	logTextU8sevkv	(
+		put, cunilogEvtSeverityInfo, "Request",
+		cunilogField ("path", cunilogArg (szPath)), cunilogField ("status", cunilogArg (iStatus))
+					);
+
+	The functions logTextU8sevlref () and logTextU8sevlrefq () do not copy the text ccText
+	but log it by reference (see CreateCUNILOG_EVENT_TextRef ()). The text must outlive the
+	processing of the event, which is the case for string literals and other static text.
+	The macros logTextU8sevlit () and logTextU8sevlitq () log a string literal without
+	calling strlen ().
+
+	Functions ending in key take a sampling key ccKey with length lenKey, which can be
+	USE_STRLEN. If the target samples the event's severity (see
+	ConfigCUNILOG_TARGETsampling ()), the key instead of a counter decides whether the event
+	is kept, which keeps or drops all events with the same key, like the lines of a single
+	request, together.
+
 	The functions logTextU8smbfmtsev () and logTextU8smbfmt () additionally expect an
 	initialised parameter structure of type SMEMBUF. The SMEMBUF structure can be re-used
 	for consecutive calls. Within the same thread this can save memory allocations if the
@@ -2011,6 +2413,12 @@ TYPEDEF_FNCT_PTR (bool, logEv) (CUNILOG_TARGET *put, CUNILOG_EVENT *pev);
 	on the CUNILOG_TARGET structure put points to.
 */
 bool logTextU8sevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len);
+bool logTextU8sevv			(CUNILOG_TARGET *put, cueventseverity sev, const CUNILOG_FRAGMENT *pfr, size_t nfr);
+bool logTextU8v				(CUNILOG_TARGET *put, const CUNILOG_FRAGMENT *pfr, size_t nfr);
+bool logTextU8sevargs		(CUNILOG_TARGET *put, cueventseverity sev, const CUNILOG_ARG *pa, size_t na);
+bool logTextU8sevfields		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccMsg, size_t lenMsg, const CUNILOG_FIELD *pf, size_t nf);
+bool logTextU8sevlref		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len);
+bool logTextU8sevlrefq		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len);
 bool logTextU8sevlts		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len, UBF_TIMESTAMP ts);
 bool logTextU8sevlq			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len);
 bool logTextU8sevlqts		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len, UBF_TIMESTAMP ts);
@@ -2034,6 +2442,10 @@ bool logTextU8svfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 bool logTextU8sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...);
 bool logTextU8smbvfmtsev	(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev, const char *fmt, va_list ap);
 bool logTextU8smbfmtsev		(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev, const char *fmt, ...);
+bool logTextU8sevlkey		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccKey, size_t lenKey, const char *ccText, size_t len);
+bool logTextU8svfmtsevkey	(CUNILOG_TARGET *put, cueventseverity sev, const char *ccKey, size_t lenKey, const char *fmt, va_list ap);
+bool logTextU8sfmtsevkey	(CUNILOG_TARGET *put, cueventseverity sev, const char *ccKey, size_t lenKey, const char *fmt, ...);
+
 bool logTextU8smbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_list ap);
 bool logTextU8smbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...);
 bool logHexDumpU8sevl		(CUNILOG_TARGET *put, cueventseverity sev, const void *pBlob, size_t size, const char *ccCaption, size_t lenCaption);
@@ -2054,6 +2466,118 @@ bool logTextWU16svfmtsev	(CUNILOG_TARGET *put, cueventseverity sev, const wchar_
 bool logTextWU16sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const wchar_t *wcFmt, ...);
 #endif
 
+/*
+	Typed arguments for logTextU8sevargs () and logTextU8sevt ().
+*/
+static inline CUNILOG_ARG cunilogArgStrl (const char *cc, size_t len)
+{
+	CUNILOG_ARG a;
+	a.type	= cunilogArgTypeStr;
+	a.v.cc	= cc;
+	a.len	= len;
+	return a;
+}
+static inline CUNILOG_ARG cunilogArgStr (const char *cc)
+{
+	return cunilogArgStrl (cc, USE_STRLEN);
+}
+static inline CUNILOG_ARG cunilogArgI64 (int64_t i64)
+{
+	CUNILOG_ARG a;
+	a.type	= cunilogArgTypeI64;
+	a.v.i64	= i64;
+	a.len	= 0;
+	return a;
+}
+static inline CUNILOG_ARG cunilogArgU64 (uint64_t u64)
+{
+	CUNILOG_ARG a;
+	a.type	= cunilogArgTypeU64;
+	a.v.u64	= u64;
+	a.len	= 0;
+	return a;
+}
+static inline CUNILOG_ARG cunilogArgHex (uint64_t u64)
+{
+	CUNILOG_ARG a;
+	a.type	= cunilogArgTypeHex;
+	a.v.u64	= u64;
+	a.len	= 0;
+	return a;
+}
+// nDec decimals, up to CUNILOG_ARG_FLT_MAX_DECIMALS.
+static inline CUNILOG_ARG cunilogArgFltd (double dbl, size_t nDec)
+{
+	CUNILOG_ARG a;
+	a.type	= cunilogArgTypeFlt;
+	a.v.dbl	= dbl;
+	a.len	= nDec <= CUNILOG_ARG_FLT_MAX_DECIMALS ? nDec : CUNILOG_ARG_FLT_MAX_DECIMALS;
+	return a;
+}
+static inline CUNILOG_ARG cunilogArgFlt (double dbl)
+{
+	return cunilogArgFltd (dbl, 6);
+}
+
+#if defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+	#define cunilogArg(x)									\
+		_Generic ((x),										\
+			char *:					cunilogArgStr,			\
+			const char *:			cunilogArgStr,			\
+			float:					cunilogArgFlt,			\
+			double:					cunilogArgFlt,			\
+			_Bool:					cunilogArgU64,			\
+			unsigned char:			cunilogArgU64,			\
+			unsigned short:			cunilogArgU64,			\
+			unsigned int:			cunilogArgU64,			\
+			unsigned long:			cunilogArgU64,			\
+			unsigned long long:		cunilogArgU64,			\
+			default:				cunilogArgI64			\
+				) (x)
+#endif
+
+// The arguments must be of type CUNILOG_ARG.
+#define logTextU8sevt(put, sev, ...)						\
+	logTextU8sevargs	(									\
+		(put), (sev),										\
+		(const CUNILOG_ARG []) { __VA_ARGS__ },				\
+		sizeof ((const CUNILOG_ARG []) { __VA_ARGS__ }) / sizeof (CUNILOG_ARG)	\
+						)
+#define logTextU8sevt_static(sev, ...)						\
+	logTextU8sevt (pCUNILOG_TARGETstatic, (sev), __VA_ARGS__)
+
+/*
+	Key/value fields for logTextU8sevfields () and logTextU8sevkv ().
+*/
+static inline CUNILOG_FIELD cunilogFieldl (const char *ccKey, size_t lenKey, CUNILOG_ARG val)
+{
+	CUNILOG_FIELD f;
+	f.ccKey		= ccKey;
+	f.lenKey	= lenKey;
+	f.val		= val;
+	return f;
+}
+static inline CUNILOG_FIELD cunilogField (const char *ccKey, CUNILOG_ARG val)
+{
+	return cunilogFieldl (ccKey, USE_STRLEN, val);
+}
+
+// The arguments following the message must be of type CUNILOG_FIELD.
+#define logTextU8sevkv(put, sev, msg, ...)					\
+	logTextU8sevfields	(									\
+		(put), (sev), (msg), USE_STRLEN,					\
+		(const CUNILOG_FIELD []) { __VA_ARGS__ },			\
+		sizeof ((const CUNILOG_FIELD []) { __VA_ARGS__ }) / sizeof (CUNILOG_FIELD)	\
+						)
+#define logTextU8sevkv_static(sev, msg, ...)				\
+	logTextU8sevkv (pCUNILOG_TARGETstatic, (sev), (msg), __VA_ARGS__)
+
+// Only for string literals. The "" makes sure lit is one.
+#define logTextU8sevlit(put, sev, lit)					\
+	logTextU8sevlref ((put), (sev), "" lit "", sizeof (lit) - 1)
+#define logTextU8sevlitq(put, sev, lit)					\
+	logTextU8sevlrefq ((put), (sev), "" lit "", sizeof (lit) - 1)
+
 // Console output only. No other processors are invoked.
 bool logTextU8csevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText, size_t len);
 bool logTextU8csev			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccText);
@@ -2095,6 +2619,20 @@ bool logEmptyLine			(CUNILOG_TARGET *put);
 #define logTextU8smbfmtsev_static(s, m, ...)			\
 										logTextU8smbfmtsev	(pCUNILOG_TARGETstatic, (s), (m), __VA_ARGS__)
 #define logTextU8smbfmt_static(m, ...)	logTextU8smbfmt		(pCUNILOG_TARGETstatic, (m), __VA_ARGS__)
+#define logTextU8sevv_static(v, f, n)	logTextU8sevv		(pCUNILOG_TARGETstatic, (v), (f), (n))
+#define logTextU8v_static(f, n)			logTextU8v			(pCUNILOG_TARGETstatic, (f), (n))
+#define logTextU8sevlref_static(v, t, l)				\
+										logTextU8sevlref	(pCUNILOG_TARGETstatic, (v), (t), (l))
+#define logTextU8sevlrefq_static(v, t, l)				\
+										logTextU8sevlrefq	(pCUNILOG_TARGETstatic, (v), (t), (l))
+#define logTextU8sevlit_static(v, lit)					\
+										logTextU8sevlit		(pCUNILOG_TARGETstatic, (v), lit)
+#define logTextU8sevlitq_static(v, lit)					\
+										logTextU8sevlitq	(pCUNILOG_TARGETstatic, (v), lit)
+#define logTextU8sevlkey_static(s, k, lk, t, l)			\
+										logTextU8sevlkey	(pCUNILOG_TARGETstatic, (s), (k), (lk), (t), (l))
+#define logTextU8sfmtsevkey_static(s, k, lk, ...)		\
+										logTextU8sfmtsevkey	(pCUNILOG_TARGETstatic, (s), (k), (lk), __VA_ARGS__)
 #define logHexDumpU8sevl_static(s, d, n, c, l)			\
 										logHexDumpU8sevl	(pCUNILOG_TARGETstatic, (s), (d), (n), (c), (l))
 #define logHexDumpU8l_static(d, n, c,					\
@@ -2126,6 +2664,386 @@ bool logEmptyLine			(CUNILOG_TARGET *put);
 #define logTextU8csfmtsev_static(s, ...)				\
 										logTextU8csfmtsev	(pCUNILOG_TARGETstatic, (s), __VA_ARGS__);
 
+/*
+	Compile-time elimination of event severities.
+
+	The logging functions above evaluate all their arguments before they check whether
+	the event's severity is enabled. The _if macros below check first and only then call
+	the logging function, which means their remaining arguments are not evaluated at all
+	if the severity is disabled.
+
+	CUNILOG_BUILD_SEVERITY_MASK is the mask of severities built into the application. Like
+	a target's severity mask, each bit denotes one of the cunilogEvtSeverity... values. Calls
+	of the _if macros with a constant severity whose bit is cleared are removed by the
+	compiler entirely. Since severities have no numeric relationship to each other (see
+	docs/severities.md), this is a mask and not a minimum severity. The default is to build
+	all severities. Define CUNILOG_BUILD_WITHOUT_DEBUG_SEVERITIES to remove the severities
+	cunilogEvtSeverityDebug, cunilogEvtSeverityTrace, cunilogEvtSeverityDetail, and
+	cunilogEvtSeverityVerbose from a release build.
+
+	If the severity is built in, the target's runtime severity mask is checked inline. The
+	check assumes that the severity is disabled, which keeps disabled logging on the fast
+	path.
+
+	The macros return true if the severity is disabled. Note that the arguments put and sev
+	are evaluated more than once.
+
+	Example:
+
+	logTextU8sfmtsev_if (put, cunilogEvtSeverityDebug, "Value: %s", expensiveToString (v));
+*/
+#ifndef CUNILOG_BUILD_WITHOUT_DEBUG_SEVERITIES
+//#define CUNILOG_BUILD_WITHOUT_DEBUG_SEVERITIES
+#endif
+
+#ifndef CUNILOG_BUILD_SEVERITY_MASK
+	#ifdef CUNILOG_BUILD_WITHOUT_DEBUG_SEVERITIES
+		#define CUNILOG_BUILD_SEVERITY_MASK							\
+			((evtsevmask_t)											\
+				~	(												\
+							((evtsevmask_t) 1 << cunilogEvtSeverityDebug)	\
+						|	((evtsevmask_t) 1 << cunilogEvtSeverityTrace)	\
+						|	((evtsevmask_t) 1 << cunilogEvtSeverityDetail)	\
+						|	((evtsevmask_t) 1 << cunilogEvtSeverityVerbose)	\
+					)												\
+			)
+	#else
+		#define CUNILOG_BUILD_SEVERITY_MASK		((evtsevmask_t) ~ (evtsevmask_t) 0)
+	#endif
+#endif
+
+#if defined (__GNUC__) || defined (__clang__)
+	#define CUNILOG_UNLIKELY(x)		__builtin_expect (!! (x), 0)
+#else
+	#define CUNILOG_UNLIKELY(x)		(x)
+#endif
+
+// True if the severity sev is built in. A constant expression for a constant sev.
+#define cunilogIsSeverityBuiltIn(sev)						\
+	(CUNILOG_BUILD_SEVERITY_MASK & ((evtsevmask_t) 1 << (sev)))
+
+/*
+	cunilogIsSeverityEnabled
+
+	Returns true if the severity sev is built in and enabled in the severity mask of
+	the target put points to. Disabled severities are expected to be the common case.
+*/
+static inline bool cunilogIsSeverityEnabled (CUNILOG_TARGET *put, cueventseverity sev)
+{
+	return	cunilogIsSeverityBuiltIn (sev)
+		&&	CUNILOG_UNLIKELY (put->severityEvtMask & ((evtsevmask_t) 1 << sev));
+}
+
+#define logTextU8sevl_if(put, sev, t, l)					\
+	(														\
+		cunilogIsSeverityEnabled ((put), (sev))				\
+		?	logTextU8sevl ((put), (sev), (t), (l))			\
+		:	true											\
+	)
+#define logTextU8sev_if(put, sev, t)						\
+	(														\
+		cunilogIsSeverityEnabled ((put), (sev))				\
+		?	logTextU8sev ((put), (sev), (t))				\
+		:	true											\
+	)
+#define logTextU8sevq_if(put, sev, t)						\
+	(														\
+		cunilogIsSeverityEnabled ((put), (sev))				\
+		?	logTextU8sevq ((put), (sev), (t))				\
+		:	true											\
+	)
+#define logTextU8sfmtsev_if(put, sev, ...)					\
+	(														\
+		cunilogIsSeverityEnabled ((put), (sev))				\
+		?	logTextU8sfmtsev ((put), (sev), __VA_ARGS__)	\
+		:	true											\
+	)
+#define logHexDumpU8sevl_if(put, sev, d, n, c, l)			\
+	(														\
+		cunilogIsSeverityEnabled ((put), (sev))				\
+		?	logHexDumpU8sevl ((put), (sev), (d), (n), (c), (l))	\
+		:	true											\
+	)
+
+#define logTextU8sevl_static_if(sev, t, l)					\
+			logTextU8sevl_if (pCUNILOG_TARGETstatic, (sev), (t), (l))
+#define logTextU8sev_static_if(sev, t)						\
+			logTextU8sev_if (pCUNILOG_TARGETstatic, (sev), (t))
+#define logTextU8sevq_static_if(sev, t)						\
+			logTextU8sevq_if (pCUNILOG_TARGETstatic, (sev), (t))
+#define logTextU8sfmtsev_static_if(sev, ...)				\
+			logTextU8sfmtsev_if (pCUNILOG_TARGETstatic, (sev), __VA_ARGS__)
+#define logHexDumpU8sevl_static_if(sev, d, n, c, l)			\
+			logHexDumpU8sevl_if (pCUNILOG_TARGETstatic, (sev), (d), (n), (c), (l))
+
+/*
+	Call site switches.
+
+	Each expansion of one of the _cs macros below defines a static CUNILOG_CALLSITE
+	structure with the call site's source file, line, severity, and an enabled byte. A
+	pointer to this structure is placed in a dedicated linker section. The functions
+	cunilogEnableCallSitesByFile () and cunilogEnableCallSitesBySeverity () walk this
+	section to enable or disable call sites at runtime, for instance to only get the debug
+	output of a single module. A disabled call site costs a single load and branch. Its
+	remaining arguments are not evaluated.
+
+	All call sites are enabled initially. The severity still needs to be enabled for the
+	target, and call sites whose severity is not built in (see CUNILOG_BUILD_SEVERITY_MASK
+	above) are removed by the compiler. To only get debug output from the files in folder
+	"src/net" of a project that is compiled from its root folder, for example:
+
+	cunilogEnableCallSitesBySeverity (cunilogEvtSeverityDebug, false);
+	cunilogEnableCallSitesByFile ("src?net?*.c", true);
+	ConfigCUNILOG_TARGETenableEventSeverity (put, cunilogEvtSeverityDebug);
+
+	The argument sev must be a constant. The _cs macros are statements and not expressions,
+	i.e. their return values are discarded.
+
+	The section is private to each executable or shared library. The enable/disable macros
+	only reach the call sites of the module they are called from, which is why they're
+	macros and not exported functions. Compilers for which no linker section is supported
+	still get the switches but the enable/disable macros do not find any call sites. This
+	is indicated by CUNILOG_CALLSITES_UNSUPPORTED being defined.
+*/
+#if defined (_MSC_VER)
+	/*
+		The linker sorts the sections alphabetically by what follows the '$', and may pad
+		them with zero bytes. The first and last entry are therefore markers, and NULL
+		entries need to be skipped.
+	*/
+	#pragma section (".cunlcs$a", read)
+	#pragma section (".cunlcs$m", read)
+	#pragma section (".cunlcs$z", read)
+	#define CUNILOG_CALLSITE_SECTION								\
+		__declspec (allocate (".cunlcs$m"))
+	__declspec (allocate (".cunlcs$a")) __declspec (selectany)
+		CUNILOG_CALLSITE *const cunilogCallSitesFirst	= NULL;
+	__declspec (allocate (".cunlcs$z")) __declspec (selectany)
+		CUNILOG_CALLSITE *const cunilogCallSitesLast	= NULL;
+	#define CUNILOG_CALLSITES_BEGIN		(&cunilogCallSitesFirst + 1)
+	#define CUNILOG_CALLSITES_END		(&cunilogCallSitesLast)
+#elif (defined (__GNUC__) || defined (__clang__)) && defined (__APPLE__)
+	#define CUNILOG_CALLSITE_SECTION								\
+		__attribute__ ((section ("__DATA,cunilog_cs"), used))
+	extern CUNILOG_CALLSITE *const cunilogCallSitesMachOStart []
+		__asm ("section$start$__DATA$cunilog_cs");
+	extern CUNILOG_CALLSITE *const cunilogCallSitesMachOStop []
+		__asm ("section$end$__DATA$cunilog_cs");
+	#define CUNILOG_CALLSITES_BEGIN		(cunilogCallSitesMachOStart)
+	#define CUNILOG_CALLSITES_END		(cunilogCallSitesMachOStop)
+#elif (defined (__GNUC__) || defined (__clang__)) && defined (__ELF__)
+	/*
+		The linker provides the __start_ and __stop_ symbols for sections whose names are
+		valid C identifiers. They are weak in case a module has no call sites, and hidden
+		to not resolve to the section of another module.
+	*/
+	#define CUNILOG_CALLSITE_SECTION								\
+		__attribute__ ((section ("cunilog_callsites"), used))
+	extern CUNILOG_CALLSITE *const __start_cunilog_callsites []
+		__attribute__ ((weak, visibility ("hidden")));
+	extern CUNILOG_CALLSITE *const __stop_cunilog_callsites []
+		__attribute__ ((weak, visibility ("hidden")));
+	#define CUNILOG_CALLSITES_BEGIN		(__start_cunilog_callsites)
+	#define CUNILOG_CALLSITES_END		(__stop_cunilog_callsites)
+#else
+	#define CUNILOG_CALLSITES_UNSUPPORTED
+	#define CUNILOG_CALLSITE_SECTION
+	#define CUNILOG_CALLSITES_BEGIN		((CUNILOG_CALLSITE *const *) NULL)
+	#define CUNILOG_CALLSITES_END		((CUNILOG_CALLSITE *const *) NULL)
+#endif
+
+#ifdef CUNILOG_CALLSITES_UNSUPPORTED
+	#define CUNILOG_REGISTER_CALLSITE(cs)
+#else
+	#define CUNILOG_REGISTER_CALLSITE(cs)							\
+		CUNILOG_CALLSITE_SECTION static CUNILOG_CALLSITE *const		\
+			cunilogCallSitePtr_ = &(cs)
+#endif
+
+/*
+	CUNILOG_CALLSITE_IF
+
+	Defines and registers the call site structure and executes the statement stmt if the
+	severity sev is built in and the call site is enabled.
+*/
+#define CUNILOG_CALLSITE_IF(sev, stmt)							\
+	do															\
+	{															\
+		static CUNILOG_CALLSITE cunilogCallSite_ =				\
+			{__FILE__, __LINE__, (sev), 1};						\
+		CUNILOG_REGISTER_CALLSITE (cunilogCallSite_);			\
+		if (cunilogIsSeverityBuiltIn (sev) && cunilogCallSite_.bEnabled)	\
+			stmt;												\
+	} while (0)
+
+#define logTextU8sevl_cs(put, sev, t, l)					\
+	CUNILOG_CALLSITE_IF ((sev), logTextU8sevl ((put), (sev), (t), (l)))
+#define logTextU8sev_cs(put, sev, t)						\
+	CUNILOG_CALLSITE_IF ((sev), logTextU8sev ((put), (sev), (t)))
+#define logTextU8sevq_cs(put, sev, t)						\
+	CUNILOG_CALLSITE_IF ((sev), logTextU8sevq ((put), (sev), (t)))
+#define logTextU8sfmtsev_cs(put, sev, ...)					\
+	CUNILOG_CALLSITE_IF ((sev), logTextU8sfmtsev ((put), (sev), __VA_ARGS__))
+#define logHexDumpU8sevl_cs(put, sev, d, n, c, l)			\
+	CUNILOG_CALLSITE_IF ((sev), logHexDumpU8sevl ((put), (sev), (d), (n), (c), (l)))
+
+#define logTextU8sevl_static_cs(sev, t, l)					\
+			logTextU8sevl_cs (pCUNILOG_TARGETstatic, (sev), (t), (l))
+#define logTextU8sev_static_cs(sev, t)						\
+			logTextU8sev_cs (pCUNILOG_TARGETstatic, (sev), (t))
+#define logTextU8sevq_static_cs(sev, t)						\
+			logTextU8sevq_cs (pCUNILOG_TARGETstatic, (sev), (t))
+#define logTextU8sfmtsev_static_cs(sev, ...)				\
+			logTextU8sfmtsev_cs (pCUNILOG_TARGETstatic, (sev), __VA_ARGS__)
+#define logHexDumpU8sevl_static_cs(sev, d, n, c, l)			\
+			logHexDumpU8sevl_cs (pCUNILOG_TARGETstatic, (sev), (d), (n), (c), (l))
+
+/*
+	cunilogRateLimitPass
+
+	Token bucket rate limit for events. Returns true if an event with severity sev may be
+	logged to the target put points to, false if it should be suppressed. The bucket prl
+	points to holds up to uiBurst events and is refilled with uiPerSecond events per
+	second. It is checked on the caller's side before an event is created. A suppressed
+	event therefore costs neither memory allocation nor a place in the queue.
+
+	When an event passes the bucket after events have been suppressed, the function
+	first logs the text "Suppressed <n> similar events." with severity sev, hence the
+	suppressed events are reported at the rate of the bucket while they keep coming.
+	Counts that are still pending are reported by ShutdownCUNILOG_TARGET ().
+
+	The bucket is usually a static one per call site. See the _rl macros below. It can
+	also be chosen by the caller, for instance to limit the events of a certain message
+	or the events of a group of call sites. The bucket is updated atomically without
+	taking the lock of the target. Threads only contend for the bucket itself. A bucket
+	should only be used with a single target at a time.
+*/
+bool cunilogRateLimitPass	(
+		CUNILOG_TARGET				*put,
+		CUNILOG_RATELIMIT			*prl,
+		cueventseverity				sev,
+		uint32_t					uiPerSecond,
+		uint32_t					uiBurst
+							)
+;
+TYPEDEF_FNCT_PTR (bool, cunilogRateLimitPass)
+(
+		CUNILOG_TARGET				*put,
+		CUNILOG_RATELIMIT			*prl,
+		cueventseverity				sev,
+		uint32_t					uiPerSecond,
+		uint32_t					uiBurst
+)
+;
+
+/*
+	CUNILOG_RATELIMIT_IF
+
+	Executes the statement stmt if the severity sev is enabled for the target put and the
+	static token bucket of the call site lets the event pass. The _rl macros are built on
+	it. Their arguments r and b are the rate per second and the burst size. Like the _cs
+	macros, they're statements and not expressions, and their remaining arguments are not
+	evaluated for suppressed events.
+
+	Example:
+
+	logTextU8sfmtsev_rl (put, cunilogEvtSeverityError, 10, 100, "Error %d", iErr);
+*/
+#define CUNILOG_RATELIMIT_IF(put, sev, r, b, stmt)				\
+	do															\
+	{															\
+		static CUNILOG_RATELIMIT cunilogRateLimit_;				\
+		if	(													\
+					cunilogIsSeverityEnabled ((put), (sev))		\
+				&&	cunilogRateLimitPass						(	\
+						(put), &cunilogRateLimit_, (sev), (r), (b)	\
+															)	\
+			)													\
+			stmt;												\
+	} while (0)
+
+#define logTextU8sevl_rl(put, sev, r, b, t, l)				\
+	CUNILOG_RATELIMIT_IF ((put), (sev), (r), (b), logTextU8sevl ((put), (sev), (t), (l)))
+#define logTextU8sev_rl(put, sev, r, b, t)					\
+	CUNILOG_RATELIMIT_IF ((put), (sev), (r), (b), logTextU8sev ((put), (sev), (t)))
+#define logTextU8sfmtsev_rl(put, sev, r, b, ...)			\
+	CUNILOG_RATELIMIT_IF ((put), (sev), (r), (b), logTextU8sfmtsev ((put), (sev), __VA_ARGS__))
+
+#define logTextU8sevl_static_rl(sev, r, b, t, l)			\
+			logTextU8sevl_rl (pCUNILOG_TARGETstatic, (sev), (r), (b), (t), (l))
+#define logTextU8sev_static_rl(sev, r, b, t)				\
+			logTextU8sev_rl (pCUNILOG_TARGETstatic, (sev), (r), (b), (t))
+#define logTextU8sfmtsev_static_rl(sev, r, b, ...)			\
+			logTextU8sfmtsev_rl (pCUNILOG_TARGETstatic, (sev), (r), (b), __VA_ARGS__)
+
+/*
+	cunilogEnableCallSitesInRangeByFile
+	cunilogEnableCallSitesInRangeBySeverity
+
+	Enable (bEnable true) or disable (bEnable false) the call sites between ppBegin and
+	ppEnd whose source file name matches the glob pattern szGlob with length lnGlob, or
+	whose severity is sev. The file names are the __FILE__ expansions of the call sites,
+	which depend on how the compiler has been invoked. The function
+	matchWildcardPattern () compares the names against szGlob. See its description in
+	strwildcards.h for the wildcards supported. The parameter lnGlob can be USE_STRLEN.
+
+	The functions return the number of call sites that matched.
+
+	Use the macros cunilogEnableCallSitesByFile () and cunilogEnableCallSitesBySeverity ()
+	instead of calling these functions directly. They provide the call sites of the
+	calling module.
+*/
+unsigned int cunilogEnableCallSitesInRangeByFile	(
+		CUNILOG_CALLSITE *const		*ppBegin,
+		CUNILOG_CALLSITE *const		*ppEnd,
+		const char					*szGlob,
+		size_t						lnGlob,
+		bool						bEnable
+													)
+;
+TYPEDEF_FNCT_PTR (unsigned int, cunilogEnableCallSitesInRangeByFile)
+(
+		CUNILOG_CALLSITE *const		*ppBegin,
+		CUNILOG_CALLSITE *const		*ppEnd,
+		const char					*szGlob,
+		size_t						lnGlob,
+		bool						bEnable
+)
+;
+unsigned int cunilogEnableCallSitesInRangeBySeverity	(
+		CUNILOG_CALLSITE *const		*ppBegin,
+		CUNILOG_CALLSITE *const		*ppEnd,
+		cueventseverity				sev,
+		bool						bEnable
+														)
+;
+TYPEDEF_FNCT_PTR (unsigned int, cunilogEnableCallSitesInRangeBySeverity)
+(
+		CUNILOG_CALLSITE *const		*ppBegin,
+		CUNILOG_CALLSITE *const		*ppEnd,
+		cueventseverity				sev,
+		bool						bEnable
+)
+;
+
+/*
+	cunilogEnableCallSitesByFile
+	cunilogEnableCallSitesBySeverity
+
+	Enable or disable the call sites of the calling module by file name glob pattern or
+	by severity. See cunilogEnableCallSitesInRangeByFile ().
+*/
+#define cunilogEnableCallSitesByFile(glob, b)				\
+			cunilogEnableCallSitesInRangeByFile				(	\
+				CUNILOG_CALLSITES_BEGIN, CUNILOG_CALLSITES_END,	\
+				(glob), USE_STRLEN, (b)							\
+															)
+#define cunilogEnableCallSitesBySeverity(sev, b)			\
+			cunilogEnableCallSitesInRangeBySeverity			(	\
+				CUNILOG_CALLSITES_BEGIN, CUNILOG_CALLSITES_END,	\
+				(sev), (b)										\
+															)
+
 /*!	ChangeCUNILOG_TARGETuseColourForCout
 	ChangeCUNILOG_TARGETuseColorForCout
 	ChangeCUNILOG_TARGETuseColourForCout
@@ -2191,6 +3109,20 @@ bool logEmptyLine			(CUNILOG_TARGET *put);
 	TYPEDEF_FNCT_PTR (bool, ChangeCUNILOG_TARGETenableCoutProcessor)	(CUNILOG_TARGET *put);
 #endif
 
+/*!
+	ChangeCUNILOG_TARGETrescanLogfiles
+
+	Queues an event that discards the target's list of logfiles so that it is read from
+	disk again the next time a rotation processor needs it. See
+	ConfigCUNILOG_TARGETrescanLogfiles () for more information.
+
+	The function returns true if the event was queued successfully, false otherwise.
+*/
+#ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
+	bool ChangeCUNILOG_TARGETrescanLogfiles (CUNILOG_TARGET *put);
+	TYPEDEF_FNCT_PTR (bool, ChangeCUNILOG_TARGETrescanLogfiles) (CUNILOG_TARGET *put);
+#endif
+
 /*!
 	ChangeCUNILOG_TARGETeventSeverityFormat
 
@@ -85,6 +85,7 @@ SCULCMDARR culCmdSizes [] =
 	,	SIZCMDENUM											// cunilogConfigDisableEchoProcessor
 	,	SIZCMDENUM											// cunilogConfigEnableEchoProcessor
 	,	SIZCMDENUM + sizeof (cunilogprio)					// cunilogCmdConfigSetLogPriority
+	,	SIZCMDENUM											// cunilogCmdConfigRescanLogfiles
 };
 
 #ifdef DEBUG
@@ -153,6 +154,7 @@ void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilo
 void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
 void ConfigCUNILOG_TARGETdisableCoutProcessor (CUNILOG_TARGET *put);
 void ConfigCUNILOG_TARGETenableCoutProcessor (CUNILOG_TARGET *put);
+void ConfigCUNILOG_TARGETrescanLogfiles (CUNILOG_TARGET *put);
 
 void culCmdStoreCmdConfigDisableTaskProcessors (unsigned char *szOut, enum cunilogprocesstask task)
 {
@@ -326,6 +328,9 @@ void culCmdChangeCmdConfigFromCommand (CUNILOG_EVENT *pev)
 		case cunilogCmdConfigSetLogPriority:
 			culCmdConfigSetLogPriority (szData);
 			break;
+		case cunilogCmdConfigRescanLogfiles:
+			ConfigCUNILOG_TARGETrescanLogfiles (put);
+			break;
 	}
 }
 
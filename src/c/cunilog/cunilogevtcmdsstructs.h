@@ -71,6 +71,7 @@ enum cunilogEvtCmd
 	,	cunilogCmdConfigDisableEchoProcessor
 	,	cunilogCmdConfigEnableEchoProcessor
 	,	cunilogCmdConfigSetLogPriority
+	,	cunilogCmdConfigRescanLogfiles
 	// Do not add anything below this line.
 	,	cunilogCmdConfigXAmountEnumValues						// Used for sanity checks.
 	// Do not add anything below cunilogCmdConfigXAmountEnumValues.
@@ -179,6 +179,8 @@ When		Who				What
 	*/
 #else
 	#define CUNILOG_DEFAULT_OPEN_MODE	(O_WRONLY | O_APPEND | O_CREAT | O_LARGEFILE)
+	// Permissions for a new logfile. The process's umask still applies.
+	#define CUNILOG_DEFAULT_OPEN_PERMS	(0666)
 #endif
 
 BEGIN_C_DECLS
@@ -375,6 +377,9 @@ enum cunilogpostfix
 
 	A custom processor. The member pData points to a CUNILOG_CUSTPROCESS structure that
 	contains a pointer to a callback function to carry out the actual task of the processor.
+	The structure can be initialised with CUNILOG_INIT_DEF_CUSTPROCESS () or
+	CUNILOG_INIT_DEF_CUSTPROCESS_BATCH (). The latter requires the processor's option
+	flag OPT_CUNPROC_BATCH.
 
 
 	cunilogProcessTargetRedirector
@@ -386,6 +391,28 @@ enum cunilogpostfix
 	If pData is NULL, no redirection takes place and the remaining processors are worked
 	through as usual. Since this is most likely not what the caller intended, a debug
 	assertion expects pData not being NULL.
+
+
+	cunilogProcessTargetFork
+
+	Sends the event to another target too. The member pData points to a fully initialised
+	CUNILOG_TARGET structure. The remaining processors of the current target are worked
+	through as usual.
+
+	Neither this processor nor cunilogProcessTargetRedirector copy the event's data. The
+	other target receives a small event structure of its own that shares the data with the
+	original event. See cunilogShareCUNILOG_EVENT (). The event line rendered by the
+	current target is shared too. The other target only renders the event line again if
+	its timestamp format, severity format, new line sequence, or dump width differ.
+
+
+	cunilogProcessCollapseDuplicates
+
+	Collapses runs of identical events. The member pData points to a CUNILOG_COLLAPSE_DATA
+	structure. An event with the same text and severity as the previous one is swallowed,
+	i.e. the remaining processors are skipped. When a different event arrives, a
+	"Last message repeated <n> times." event is passed to the remaining processors first.
+	This processor should therefore be the first one in the processor list.
 */
 enum cunilogprocesstask
 {
@@ -398,6 +425,7 @@ enum cunilogprocesstask
 	,	cunilogProcessCustomProcessor						// An external/custom processor.
 	,	cunilogProcessTargetRedirector						// Redirect to different target.
 	,	cunilogProcessTargetFork							// Fork the event to another target.
+	,	cunilogProcessCollapseDuplicates					// Collapse identical events.
 	// Do not add anything below this line.
 	,	cunilogProcessXAmountEnumValues						// Used for table sizes.
 	// Do not add anything below cunilogProcessAmountEnumValues.
@@ -429,6 +457,16 @@ enum cunilogprocessfrequency
 };
 
 typedef struct CUNILOG_TARGET CUNILOG_TARGET;
+/*!
+	The severity mask. Each bit denotes one of the cunilogEvtSeverity... values.
+	Bit 0 is cunilogEvtSeverityNone, etc.
+	Every event's severity level is checked against this mask. If a bit is 1, the
+	event is processed. If a bit is 0, the event creation is refused and logging
+	functions with this severity fail (return false).
+*/
+typedef uint32_t			evtsevmask_t;
+#define MAX_EVTSEVMASK		UINT32_MAX;						// To set all bits to 1.
+
 typedef struct cunilog_processor
 {
 	enum cunilogprocesstask			task;					// What to apply.
@@ -443,8 +481,48 @@ typedef struct cunilog_processor
 	void							*pData;					// Pointer to processor-specific data.
 	uint64_t						uiOpts;					// Option flags. See OPT_CUNPROC_
 															//	definitions below.
+
+	/*
+		Severities this processor skips. Each bit denotes one of the cunilogEvtSeverity...
+		values, like in the target's severity mask, but a set bit means that events with
+		this severity are not processed by this processor. The next processor is then
+		run unconditionally. Initialisers that don't list this member leave it at 0, i.e.
+		all severities are processed. See ConfigCUNILOG_PROCESSORseverityMask ().
+	*/
+	evtsevmask_t					sevSkipMask;
+
+	// The pending event lines of a custom processor with a batch callback function.
+	//	Maintained by Cunilog. Reset to NULL when the target takes over the processor.
+	struct cunilog_custbatch		*pcb;
 } CUNILOG_PROCESSOR;
 
+struct CUNILOG_EVENT;
+
+/*
+	CUNILOG_PLAN_ENTRY
+
+	An entry of the execution plan of a target's processors. The plan only contains the
+	processors that are not disabled, together with their processor functions. For
+	processors with a time-based frequency, uiDeadline is the highest timestamp for which
+	the processor's threshold cannot be reached yet, or 0 if there's no such timestamp.
+	Events up to this timestamp skip the processor without updating its threshold.
+	Maintained by Cunilog. See member pplan of a CUNILOG_TARGET structure.
+
+	The plan is rebuilt before the next event when the processors are changed with
+	ConfigCUNILOG_TARGETprocessorList (), ConfigCUNILOG_TARGETdisableTaskProcessors (),
+	or ConfigCUNILOG_TARGETenableTaskProcessors (). A processor whose option flag
+	OPT_CUNPROC_DISABLED is set directly is still skipped. After other direct changes,
+	like clearing this flag, ConfigCUNILOG_TARGETprocessorsChanged () must be called.
+*/
+typedef struct cunilog_plan_entry
+{
+	CUNILOG_PROCESSOR				*cup;
+	bool							(*fnc) (CUNILOG_PROCESSOR *, struct CUNILOG_EVENT *);
+	uint64_t						uiMask;					// Timestamp bits of the frequency's
+															//	period, or 0.
+	uint64_t						uiDeadline;
+} CUNILOG_PLAN_ENTRY;
+
 /*
 	Option flags for the uiOpts member of a CUNILOG_PROCESSOR structure.
 */
@@ -464,6 +542,24 @@ typedef struct cunilog_processor
 															//	Carries on with the next processor
 															//	unconditionally, just like
 															//	OPT_CUNPROC_FORCE_NEXT.
+#define OPT_CUNPROC_JSON				SINGLEBIT64 (5)		// Output events as JSON Lines instead
+															//	of event lines. Only for
+															//	cunilogProcessEchoToConsole and
+															//	cunilogProcessWriteToLogFile
+															//	processors, and custom processors
+															//	with the option OPT_CUNPROC_BATCH.
+#define OPT_CUNPROC_ASYNC				SINGLEBIT64 (6)		// The processor runs on its own
+															//	asynchronous stage, with a bounded
+															//	buffer that drops output when
+															//	full. Currently only for
+															//	cunilogProcessEchoToConsole
+															//	processors. Ignored in
+															//	single-threaded builds.
+#define OPT_CUNPROC_BATCH				SINGLEBIT64 (7)		// Custom processors only. Hands the
+															//	event lines to the batch callback
+															//	function procBatch of the
+															//	CUNILOG_CUSTPROCESS structure
+															//	instead of calling procFnct.
 
 /*
 	Macros for some flags.
@@ -481,6 +577,17 @@ typedef struct cunilog_processor
 #define optCunProcClrOPT_CUNPROC_DISABLED(v)			\
 	((v) &= ~ OPT_CUNPROC_DISABLED)
 
+#define optCunProcHasOPT_CUNPROC_JSON(v)				\
+	((v) & OPT_CUNPROC_JSON)
+
+#define optCunProcHasOPT_CUNPROC_ASYNC(v)				\
+	((v) & OPT_CUNPROC_ASYNC)
+#define optCunProcClrOPT_CUNPROC_ASYNC(v)				\
+	((v) &= ~ OPT_CUNPROC_ASYNC)
+
+#define optCunProcHasOPT_CUNPROC_BATCH(v)				\
+	((v) & OPT_CUNPROC_BATCH)
+
 /*
 	A pData structure for a unilogProcessWriteToLogFile or a unilogProcessFlushLogFile processor.
 */
@@ -548,6 +655,24 @@ typedef struct cunilog_rotation_data
 	uint64_t					uiData;
 
 	uint64_t					uiFlgs;						// Option flags. See below.
+
+	/*
+		Size budget in octets for all logfiles together. When not 0, the rotator also
+		processes the least recent logfiles whose sizes, added to the sizes of all more
+		recent logfiles, exceed this value. The current logfile is never processed for
+		this reason. Only useful for rotators that delete logfiles or move them to the
+		trash/recycle bin. The sizes are tracked by the target and not obtained from the
+		file system for each rotation. The initialisers below set this member to 0, i.e.
+		no size budget.
+
+		The budget covers the logfiles in the target's files list with their logical
+		(uncompressed) sizes on all platforms. Logfiles compressed by the file system,
+		for instance NTFS, therefore count with their uncompressed size. Logfiles
+		compressed to ".gz" archives stay in the files list and count with the size of
+		the archive, except for dot number postfixes, where archives are not part of the
+		files list and don't count.
+	*/
+	uint64_t					uiMaxTotalSize;
 } CUNILOG_ROTATION_DATA;
 
 /*
@@ -670,7 +795,8 @@ enum enClgCmprsMtd
 	0, 0, CUNILOG_MAX_ROTATE_AUTO,						\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL, 0,											\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0													\
 }
 
 /*
@@ -682,7 +808,8 @@ enum enClgCmprsMtd
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL, 0,											\
-	CUNILOG_ROTATOR_COMPRESS_DEFAULT					\
+	CUNILOG_ROTATOR_COMPRESS_DEFAULT,					\
+	0													\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_TRASH(k)\
 {														\
@@ -690,7 +817,8 @@ enum enClgCmprsMtd
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL, 0,											\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0													\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_RECYCLE_BIN(k)\
 {														\
@@ -698,7 +826,8 @@ enum enClgCmprsMtd
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL, 0,											\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0													\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE(k)\
 {														\
@@ -706,7 +835,8 @@ enum enClgCmprsMtd
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL, 0,											\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0													\
 }
 
 /*
@@ -718,7 +848,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_nAlways,					\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, NULL												\
 }
 #define CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR	\
 {														\
@@ -726,7 +857,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, NULL												\
 }
 #define CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR		\
 {														\
@@ -734,7 +866,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_nAlways,					\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, NULL												\
 }
 #define CUNILOG_INIT_DEF_FLUSHLOGFILE_PROCESSOR			\
 {														\
@@ -742,7 +875,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, NULL												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -756,7 +890,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, NULL												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -770,7 +905,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, NULL												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -782,7 +918,8 @@ enum enClgCmprsMtd
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, NULL												\
 }
 
 
@@ -802,7 +939,9 @@ enum enClgCmprsMtd
 	(cup)->thr		= thrs;								\
 	(cup)->cur		= 0;								\
 	(cup)->pData	= NULL;								\
-	(cup)->uiOpts	= OPT_CUNPROC_NONE;
+	(cup)->uiOpts	= OPT_CUNPROC_NONE;					\
+	(cup)->sevSkipMask	= 0;							\
+	(cup)->pcb		= NULL;
 
 #ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	typedef struct CUNILOG_EVENT CUNILOG_EVENT;
@@ -906,6 +1045,9 @@ typedef struct cunilog_fls
 {
 	const char	*chFilename;
 	size_t		stFilename;
+	uint64_t	uiSize;										// Size of the file in octets. Not
+															//	maintained for the current
+															//	logfile. See uiLogfileSize.
 } CUNILOG_FLS;
 typedef vec_t(CUNILOG_FLS) vec_cunilog_fls;
 
@@ -1046,15 +1188,66 @@ extern cueventseverityformat cunilogEvtSeverityFormatDefault;
 */
 extern bool bUseCunilogDefaultOutputColour;
 
-/*!
-	The severity mask. Each bit denotes one of the cunilogEvtSeverity... values.
-	Bit 0 is cunilogEvtSeverityNone, etc.
-	Every event's severity level is checked against this mask. If a bit is 1, the
-	event is processed. If a bit is 0, the event creation is refused and logging
-	functions with this severity fail (return false).
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		A stage of adaptive load shedding. When the amount of events waiting in the queue
+		of a target with a separate logging thread reaches nDepth, events with the
+		severities in mask are discarded before they are created. See
+		ConfigCUNILOG_TARGETloadShedding ().
+	*/
+	typedef struct cunilog_shed_stage
+	{
+		size_t					nDepth;						// Queue depth of this stage.
+		evtsevmask_t			mask;						// Severities to discard.
+	} CUNILOG_SHED_STAGE;
+
+	#ifndef CUNILOG_MAX_SHED_STAGES
+	#define CUNILOG_MAX_SHED_STAGES		(4)
+	#endif
+
+	typedef struct cunilog_shedding
+	{
+		CUNILOG_SHED_STAGE		stages [CUNILOG_MAX_SHED_STAGES];
+		unsigned int			nStages;					// Stages in use. 0 for none.
+		size_t					nLowWater;					// Shedding ends when the logging
+															//	thread dequeues no more events
+															//	than this at once.
+		volatile evtsevmask_t	active;						// Severities currently discarded.
+		volatile uint64_t		nShed;						// Events discarded so far.
+	} CUNILOG_SHEDDING;
+#endif
+
+/*
+	Sampling rates per event severity. See ConfigCUNILOG_TARGETsampling (). There's one
+	element for every bit of the severity mask. A value of 0 or 1 keeps all events of the
+	severity, a value of n keeps 1 in n events.
 */
-typedef uint32_t			evtsevmask_t;
-#define MAX_EVTSEVMASK		UINT32_MAX;						// To set all bits to 1.
+#define CUNILOG_SAMPLING_SLOTS		(8 * sizeof (evtsevmask_t))
+typedef struct cunilog_sampling
+{
+	volatile uint32_t		auiOneIn [CUNILOG_SAMPLING_SLOTS];
+	volatile uint32_t		auiCount [CUNILOG_SAMPLING_SLOTS];
+} CUNILOG_SAMPLING;
+
+/*
+	The asynchronous stage of a console output processor with option flag
+	OPT_CUNPROC_ASYNC. The processor appends its output to the pending buffer, and the
+	stage's own thread writes it to stdout. Both buffers have a size of
+	CUNILOG_COUT_ASYNC_SIZE octets.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	typedef struct cunilog_cout_async
+	{
+		CUNILOG_LOCKER				cl;						// Protects the members below.
+		CUNILOG_SEMAPHORE			sm;						// Wakes up the thread.
+		CUNILOG_THREAD				th;
+		char						*pchPending;			// Output not yet taken by the thread.
+		size_t						lnPending;				// Its length.
+		char						*pchWriting;			// Output the thread is writing.
+		uint64_t					nDropped;				// Lines dropped since the last notice.
+		bool						bShutdown;
+	} CUNILOG_COUT_ASYNC;
+#endif
 
 /*!
 	SUNILOGTARGET
@@ -1079,10 +1272,19 @@ typedef struct CUNILOG_TARGET
 															//	Same as mbLogPath but NUL-terminated
 															//	and without slash at the end.
 		size_t						lnLogFold;				// Its length exl. NUL terminator.
+		int							fdLogFold;				// Descriptor of the logging folder
+															//	or -1. Rotators and the logfile
+															//	work relative to it.
 	#endif
 	SMEMBUF							mbLogfileName;			// Path and name of current log file.
 	char							*szDateTimeStamp;		// Points inside mbLogfileName.buf.pch.
-	char							cPrevDateTimeStamp [LEN_ISO8601DATEHOURANDMINUTE];
+	uint64_t						uiPostfixPeriodStart;	// UBF_TIMESTAMP at which the period of
+															//	the postfix in mbLogfileName starts.
+	uint64_t						uiPostfixPeriodEnd;		// UBF_TIMESTAMP at which the period of
+															//	the postfix in mbLogfileName ends,
+															//	or 0 if not generated yet.
+	uint64_t						uiOpenPeriodEnd;		// uiPostfixPeriodEnd when the current
+															//	logfile has been opened.
 	SMEMBUF							mbLogFileMask;			// The search mask for log files. It
 															//	does not include the path.
 	size_t							lnLogFileMask;			// Its length.
@@ -1092,13 +1294,26 @@ typedef struct CUNILOG_TARGET
 	size_t							lnFilToRotate;			// Its length excluding the NUL terminator.
 	SMEMBUF							mbLogEventLine;			// Buffer that holds the event line.
 	size_t							lnLogEventLine;			// The current length of the event line.
-
-	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-		SMEMBUF						mbColEventLine;			// Buffer that holds the coloured
-															//	event line.
-		size_t						lnColEventLine;			// The current length of the coloured
-															//	event line.
-	#endif
+	SMEMBUF							mbJSONLine;				// The event as JSON Lines line. Only
+															//	created when a processor with
+															//	option OPT_CUNPROC_JSON requires it.
+	size_t							lnJSONLine;				// Its length.
+	struct CUNILOG_EVENT			*pevJSONLine;			// The event it has been created for.
+	SMEMBUF							mbCoutBuf;				// Console output not written yet. Only
+															//	with CUNILOGTARGET_COUT_BUFFERED.
+	size_t							lnCoutBuf;				// Its length.
+	uint64_t						uiCoutBatchStart;		// When the first line of the current
+															//	batch has been added to it.
+	struct cunilog_cout_async		*pcas;					// Asynchronous console output stage,
+															//	or NULL. See OPT_CUNPROC_ASYNC.
+	CUNILOG_PLAN_ENTRY				*pplan;					// Execution plan of the processors.
+	unsigned int					nplan;					// Entries in pplan.
+	volatile bool					bPlanOutdated;			// Rebuild pplan before the next event.
+	struct cunilog_ratelimit *volatile	prlBuckets;			// Token buckets with suppressed
+															//	events. See cunilogRateLimitPass ().
+	uint64_t						uiWeekKeyDay;			// Day (UBF_TIMESTAMP_KEEP_FROM_DAY_BITS)
+															//	uiWeekKey has been computed for.
+	uint64_t						uiWeekKey;				// ISO 8601 year and week of that day.
 
 	DBG_DEFINE_CNTTRACKER(evtLineTracker)					// Tracker for the size of the event
 															//	line.
@@ -1124,20 +1339,32 @@ typedef struct CUNILOG_TARGET
 
 		size_t						nPausedEvents;			// Amount of events queued because
 															//	the logging thread is/was paused.
+
+		CUNILOG_SHEDDING			shed;					// Adaptive load shedding.
 	#endif
 
 	enum cunilogeventTSformat		unilogEvtTSformat;		// The format of an event timestamp.
 	newline_t						culogNewLine;
 	CUNILOG_LOGFILE					logfile;
+	uint64_t						uiLogfileSize;			// Size of the current logfile in
+															//	octets. Obtained when it is opened
+															//	and updated with every write.
 	SBULKMEM						sbm;					// Bulk memory block.
 	vec_cunilog_fls					fls;					// The vector with str pointers to
 															//	the files to rotate within sbm.
+	uint64_t						uiLogFoldMtime;			// Modification time of the logging
+															//	folder when fls was last known to
+															//	be in sync with it.
+	uint64_t						uiArchivedDotNumber;	// Highest dot number of the compressed
+															//	logfiles "<app>.log.<n>.<ext>",
+															//	which are not part of fls.
 	// We're not using the configurable dump anymore.
 	//SCUNILOGDUMP					*psdump;				// Holds the dump parameters.
 	ddumpWidth						dumpWidth;
 
 	cueventseverityformat				severityPrefix;			// Format of the event severity.
 	volatile evtsevmask_t			severityEvtMask;
+	CUNILOG_SAMPLING				*psmpl;					// Sampling rates, or NULL.
 
 	CUNILOG_ERROR					error;
 	#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
@@ -1368,6 +1595,21 @@ typedef struct CUNILOG_TARGET
 // Colour information should be used.
 #define CUNILOGTARGET_USE_COLOUR_FOR_COUT		SINGLEBIT64 (36)
 
+/*
+	Only applies to the dot number postfixes (cunilogPostfixDotNumberMinutely etc.).
+	Instead of renaming every "file.log.<n>" to "file.log.<n + 1>" on each rotation,
+	only the active logfile "file.log" is renamed to "file.log.<highest n + 1>". Higher
+	numbers are therefore more recent logfiles, and a rotation costs exactly one rename.
+	See ConfigCUNILOG_TARGETdotNumberMonotonic ().
+*/
+#define CUNILOGTARGET_DOTNUMBER_MONOTONIC		SINGLEBIT64 (37)
+
+/*
+	Console output is collected in a buffer and written to stdout in batches. See
+	ConfigCUNILOG_TARGETcoutBuffered (). Set by default when stdout is not a terminal.
+*/
+#define CUNILOGTARGET_COUT_BUFFERED				SINGLEBIT64 (38)
+
 /*
 	Macros for public/user/caller flags.
 */
@@ -1407,6 +1649,20 @@ typedef struct CUNILOG_TARGET
 #define cunilogSetEnqueueTimestamps(put)				\
 	((put)->uiOpts |= CUNILOGTARGET_ENQUEUE_TIMESTAMPS)
 
+#define cunilogHasDotNumberMonotonic(put)				\
+	((put)->uiOpts & CUNILOGTARGET_DOTNUMBER_MONOTONIC)
+#define cunilogClrDotNumberMonotonic(put)				\
+	((put)->uiOpts &= ~ CUNILOGTARGET_DOTNUMBER_MONOTONIC)
+#define cunilogSetDotNumberMonotonic(put)				\
+	((put)->uiOpts |= CUNILOGTARGET_DOTNUMBER_MONOTONIC)
+
+#define cunilogHasCoutBuffered(put)						\
+	((put)->uiOpts & CUNILOGTARGET_COUT_BUFFERED)
+#define cunilogClrCoutBuffered(put)						\
+	((put)->uiOpts &= ~ CUNILOGTARGET_COUT_BUFFERED)
+#define cunilogSetCoutBuffered(put)						\
+	((put)->uiOpts |= CUNILOGTARGET_COUT_BUFFERED)
+
 
 /*
 	Event severities.
@@ -1459,12 +1715,35 @@ enum cunilogeventtype
 	,	cunilogEvtTypeHexDumpWithCaption16					// Caption length is 16 bit.
 	,	cunilogEvtTypeHexDumpWithCaption32					// Caption length is 32 bit.
 	,	cunilogEvtTypeHexDumpWithCaption64					// Caption length is 64 bit.
+
+		/*
+			Structured event. The message text is followed by key/value fields. Member
+			lenDataToLog only counts the length of the message text. See
+			CreateCUNILOG_EVENT_Fields ().
+		*/
+	,	cunilogEvtTypeFields
 	// Do not add anything below this line.
 	,	cunilogEvtTypeAmountEnumValues						// Used for sanity checks.
 	// Do not add anything below cunilogEvtTypeAmountEnumValues.
 };
 typedef enum cunilogeventtype cueventtype;
 
+/*
+	CUNILOG_LINE_CACHE
+
+	A rendered event line that is shared between targets with identical event line
+	layouts. The line with a terminating NUL follows the structure. See
+	cunilogShareCUNILOG_EVENT () and member plc of a CUNILOG_EVENT structure.
+*/
+typedef struct cunilog_line_cache
+{
+	enum cunilogeventTSformat		unilogEvtTSformat;		// Format parameters of the line.
+	cueventseverityformat			severityPrefix;
+	newline_t						culogNewLine;
+	ddumpWidth						dumpWidth;
+	size_t							lnLine;					// Length of the line.
+} CUNILOG_LINE_CACHE;
+
 /*
 	CUNILOG_EVENT
 
@@ -1491,8 +1770,81 @@ typedef struct CUNILOG_EVENT
 	size_t						sizEvent;					// The total allocated size of the
 															//	event. If 0, the size is the size
 															//	of the structure.
+	struct CUNILOG_EVENT		*pevOwner;					// If not NULL, the event that owns
+															//	szDataToLog. See
+															//	cunilogShareCUNILOG_EVENT ().
+	volatile uint32_t			nRefs;						// Additional references to the
+															//	payload of this event by events
+															//	whose pevOwner points to it.
+	CUNILOG_LINE_CACHE *volatile	plc;					// The rendered event line for the
+															//	targets the data is shared with,
+															//	or NULL. Only used if pevOwner
+															//	is NULL.
 } CUNILOG_EVENT;
 
+/*
+	CUNILOG_FRAGMENT
+
+	A fragment of the text of an event for the scatter-gather logging functions like
+	logTextU8sevv (). The member len can be USE_STRLEN if ccText is NUL-terminated.
+*/
+typedef struct cunilog_fragment
+{
+	const char					*ccText;
+	size_t						len;
+} CUNILOG_FRAGMENT;
+
+/*
+	CUNILOG_ARG
+
+	A typed argument for the printf-free logging functions like logTextU8sevargs (). The
+	arguments are normally created with the macro cunilogArg () or one of the
+	cunilogArg... () functions in cunilog.h.
+*/
+enum cunilogargtype
+{
+		cunilogArgTypeStr										// String with length.
+	,	cunilogArgTypeI64										// Signed decimal.
+	,	cunilogArgTypeU64										// Unsigned decimal.
+	,	cunilogArgTypeHex										// 16 hexadecimal digits.
+	,	cunilogArgTypeFlt										// Fixed point with len decimals.
+	// Do not add anything below this line.
+	,	cunilogArgTypeAmountEnumValues							// Used for table sizes.
+	// Do not add anything below cunilogArgTypeAmountEnumValues.
+};
+typedef enum cunilogargtype cunilogargtype;
+
+typedef struct cunilog_arg
+{
+	cunilogargtype				type;
+	union
+	{
+		const char				*cc;
+		int64_t					i64;
+		uint64_t				u64;
+		double					dbl;
+	} v;
+	size_t						len;						// Length of a string, which can be
+															//	USE_STRLEN, or the amount of
+															//	decimals of a floating point value.
+} CUNILOG_ARG;
+
+// Maximum amount of decimals for arguments of type cunilogArgTypeFlt.
+#define CUNILOG_ARG_FLT_MAX_DECIMALS	(15)
+
+/*
+	CUNILOG_FIELD
+
+	A key/value field of a structured event. See CreateCUNILOG_EVENT_Fields (). The
+	member lenKey can be USE_STRLEN if ccKey is NUL-terminated.
+*/
+typedef struct cunilog_field
+{
+	const char					*ccKey;
+	size_t						lenKey;
+	CUNILOG_ARG					val;
+} CUNILOG_FIELD;
+
 /*
 	FillCUNILOG_EVENT
 
@@ -1509,6 +1861,9 @@ typedef struct CUNILOG_EVENT
 		(pev)->lenDataToLog				= len;			\
 		(pev)->evSeverity				= sev;			\
 		(pev)->evType					= tpy;			\
+		(pev)->pevOwner					= NULL;			\
+		(pev)->nRefs					= 0;			\
+		(pev)->plc						= NULL;			\
 		(pev)->sizEvent					= siz
 #else
 	#define FillCUNILOG_EVENT(pev, pt,					\
@@ -1521,6 +1876,9 @@ typedef struct CUNILOG_EVENT
 		(pev)->next						= NULL;			\
 		(pev)->evSeverity				= sev;			\
 		(pev)->evType					= tpy;			\
+		(pev)->pevOwner					= NULL;			\
+		(pev)->nRefs					= 0;			\
+		(pev)->plc						= NULL;			\
 		(pev)->sizEvent					= siz
 #endif
 
@@ -1566,6 +1924,11 @@ typedef struct CUNILOG_EVENT
 // Only process the console output processor. All others are suppressed.
 #define CUNILOGEVENT_COUT_ONLY					SINGLEBIT64 (8)
 
+// The member szDataToLog points to caller memory that outlives the processing of the
+//	event, like a string literal, instead of data that follows the event structure.
+//	Only the structure itself has been allocated. The data must not be changed.
+#define CUNILOGEVENT_DATA_BY_REFERENCE			SINGLEBIT64 (9)
+
 // Macros to set and check flags.
 #define cunilogSetEventAllocated(pev)					\
 	((pev)->uiOpts |= CUNILOGEVENT_ALLOCATED)
@@ -1621,6 +1984,9 @@ typedef struct CUNILOG_EVENT
 #define cunilogHasEventCoutOnly(pev)					\
 	((pev)->uiOpts & CUNILOGEVENT_COUT_ONLY)
 
+#define cunilogIsEventDataByReference(pev)				\
+	((pev)->uiOpts & CUNILOGEVENT_DATA_BY_REFERENCE)
+
 /*
 	Return type of the separate logging thread.
 */
@@ -1652,6 +2018,24 @@ typedef struct CUNILOG_EVENT
 */
 typedef bool (*pfCustProc) (CUNILOG_PROCESSOR *, CUNILOG_EVENT *);
 
+/*
+	An event line handed to the batch callback function of a custom/user defined processor.
+	The line is NUL-terminated and has no new line sequence.
+*/
+typedef struct cunilog_custline
+{
+	const char					*szLine;
+	size_t						lnLine;						// Length of szLine.
+	cueventseverity				evSeverity;					// The event's severity.
+	UBF_TIMESTAMP				stamp;						// The event's timestamp.
+} CUNILOG_CUSTLINE;
+
+/*
+	A batch callback function of a custom/user defined processor. It receives the event
+	lines of all events the processor has processed within a batch of events.
+*/
+typedef void (*pfCustBatch) (CUNILOG_PROCESSOR *, const CUNILOG_CUSTLINE *, size_t);
+
 /*
 	Callback function for cleaning up a custom/user defined processor.
 */
@@ -1667,10 +2051,21 @@ typedef void (*pfDoneProc) (CUNILOG_PROCESSOR *);
 					cast the pData member of the CUNILOG_PROCESSOR structure to a pointer
 					to a CUNILOG_CUSTPROCESS structure.
 	procFnct		Pointer to a custom/user function provided by the caller that handles
-					the processor. This member cannot be NULL.
+					the processor. This member can only be NULL if the processor has the
+					option flag OPT_CUNPROC_BATCH.
 	procDone		Pointer to a function that is called when the processor is destroyed.
 					This member can be NULL if this custom (or user/external) processor
 					does not require cleanup code.
+	procBatch		Pointer to a custom/user function that receives the event lines of
+					a whole batch of events at once, or NULL. It is only used, and called
+					instead of procFnct, if the processor has the option flag
+					OPT_CUNPROC_BATCH. Targets with a separate logging thread call it
+					once for each batch of events the thread takes from the queue, other
+					targets call it for every event. The processor's frequency and
+					threshold still decide which events are part of a batch. The lines
+					are JSON Lines if the processor has the option flag OPT_CUNPROC_JSON.
+	Use one of the initialisers below instead of assigning the members one by one. This
+	ensures that members the caller does not need are NULL.
 
 	Note that there's no callback function for initialisation. If dynamic initialisation is
 	required, it is recommended to initialise pCust to NULL and initialise the custom data
@@ -1678,11 +2073,87 @@ typedef void (*pfDoneProc) (CUNILOG_PROCESSOR *);
 */
 typedef struct cunilog_customprocess
 {
-	void			*pCust;
-	pfCustProc		procFnct;
-	pfDoneProc		procDone;
+	void						*pCust;
+	pfCustProc					procFnct;
+	pfDoneProc					procDone;
+	pfCustBatch					procBatch;
 } CUNILOG_CUSTPROCESS;
 
+/*
+	Initialisers for a CUNILOG_CUSTPROCESS structure. Argument pc is the custom data
+	pointer (member pCust), fnc the processor function, bat the batch callback function,
+	and dne the cleanup function, which can be NULL.
+*/
+#define CUNILOG_INIT_DEF_CUSTPROCESS(pc, fnc, dne)			\
+{															\
+	(pc), (fnc), (dne),										\
+	NULL													\
+}
+#define CUNILOG_INIT_DEF_CUSTPROCESS_BATCH(pc, bat, dne)	\
+{															\
+	(pc), NULL, (dne),										\
+	(bat)													\
+}
+
+/*
+	FillCUNILOG_CUSTPROCESS
+
+	Function/macro to initialise a CUNILOG_CUSTPROCESS structure without a batch callback
+	function. To use a batch callback function, set the member procBatch afterwards and
+	give the processor the option flag OPT_CUNPROC_BATCH.
+*/
+#define FillCUNILOG_CUSTPROCESS(pcu, pc, fnc, dne)			\
+	ubf_assert_non_NULL (pcu);								\
+	(pcu)->pCust		= (pc);								\
+	(pcu)->procFnct		= (fnc);							\
+	(pcu)->procDone		= (dne);							\
+	(pcu)->procBatch	= NULL;
+
+/*
+	The event lines of a custom processor with a batch callback function that have not
+	been handed to the callback function yet. The lines are stored one after the other
+	in mbLines, each with a terminating NUL. The array in mbEntries has a CUNILOG_CUSTLINE
+	structure for each of them, whose member szLine is only set right before the batch is
+	handed to the callback function, since mbLines might be moved when it grows.
+*/
+typedef struct cunilog_custbatch
+{
+	SMEMBUF						mbLines;
+	size_t						lnLines;					// Octets used in mbLines.
+	SMEMBUF						mbEntries;
+	size_t						nEntries;					// Entries used in mbEntries.
+} CUNILOG_CUSTBATCH;
+
+/*
+	A pData structure for a cunilogProcessCollapseDuplicates processor.
+
+	Members:
+
+	uiMaxMs			Time limit in milliseconds. If not 0, a run of identical events that
+					lasts longer than this is reported with a "Last message repeated <n>
+					times." event when the next duplicate arrives, and the counting starts
+					over. If 0, a run is only reported when it ends.
+
+	The remaining members are used by the processor. Use the initialiser
+	CUNILOG_INIT_DEF_CUNILOG_COLLAPSE_DATA () below.
+*/
+typedef struct cunilog_collapse_data
+{
+	uint64_t			uiMaxMs;							// Time limit in ms, or 0.
+	SMEMBUF				mbLast;								// Text of the previous event.
+	size_t				lnLast;								// Its length.
+	cueventseverity		sevLast;							// Its severity.
+	uint64_t			nRepeated;							// Duplicates swallowed so far.
+	uint64_t			uiRunStart;							// From GetSystemTimeAsULONGLONGrel ().
+} CUNILOG_COLLAPSE_DATA;
+
+#define CUNILOG_INIT_DEF_CUNILOG_COLLAPSE_DATA(ms)			\
+{															\
+	(ms),													\
+	SMEMBUF_INITIALISER, 0, cunilogEvtSeverityNone,			\
+	0, 0													\
+}
+
 /*
 	Parameter structure for a rotator processor.
 */
@@ -1722,6 +2193,42 @@ typedef struct cunilogfilename
 	size_t		stLen;
 } CUNILOGFILENAME;
 
+/*
+	A call site of one of the _cs logging macros. Each expansion of such a macro defines
+	its own static instance of this structure. See the macro CUNILOG_CALLSITE_IF () in
+	cunilog.h.
+*/
+typedef struct cunilog_callsite
+{
+	const char					*szFile;					// __FILE__ of the call site.
+	unsigned int				uiLine;						// __LINE__ of the call site.
+	cueventseverity				sev;						// The severity logged.
+	volatile unsigned char		bEnabled;					// 0 if the call site is disabled.
+} CUNILOG_CALLSITE;
+
+/*
+	A token bucket for rate limiting events. See cunilogRateLimitPass () in cunilog.h. A
+	zero-initialised structure is a full bucket.
+
+	The bucket is implemented as a generic cell rate algorithm (GCRA). Instead of a time
+	and an amount of tokens it only stores the time at which the bucket is full again,
+	which can be updated atomically. A bucket that has suppressed events is added to the
+	list of buckets of its target so that the pending count can be reported when the
+	target is shut down. Only the bucket's owner (cunilogRateLimitPass ()) and the target
+	access the members.
+*/
+typedef struct cunilog_ratelimit
+{
+	volatile uint64_t			uiTAT;						// Theoretical arrival time of the next
+															//	event, from
+															//	GetSystemTimeAsULONGLONGrel ().
+	volatile uint64_t			nSuppressed;				// Events suppressed since the last
+															//	report.
+	cueventseverity				sev;						// Severity of the report.
+	volatile uint32_t			bRegistered;				// In the target's list of buckets.
+	struct cunilog_ratelimit	*pNext;						// Next bucket of the target.
+} CUNILOG_RATELIMIT;
+
 END_C_DECLS
 
 #endif														// Of #ifndef CUNILOGSTRUCTS_H.
@@ -830,169 +830,53 @@ uint32_t GetISO8601WeekDay (uint32_t y, uint8_t m, uint8_t d)
 	return (1 + ((H -1) % 7));
 }
 
-uint8_t GetISO8601WeekNumberFromDate (uint32_t y, uint8_t m, uint8_t d, uint32_t *aY)
-{
-/*
-	Implementation of http://personal.ecu.edu/mccartyr/ISOwdALG.txt:
-
-    Algorithm for Converting Gregorian Dates to ISO 8601 Week Date
-                            (Y2K  Compliant)
-                           Rick McCarty, 1999
-
-                     From: Gregorian Year-Month-Day
-                 To: ISO YearNumber-WeekNumber-Weekday 
-
-ISO 8601 specifies that Week 01 of the year is the week containing
-the first Thursday; Monday is Weekday 1, Sunday is Weekday 7;
-WeekNumber requires two digits (W01, W02, etc.; "W" is optional)
-
-Algorithm Conventions:
-   "/" = integer division, discard remainder  (5/2 = 2)
-   "%" = modulus, keep only remainder    (5%2 = 1)
-   "&" = concatenation   ("W" & 12 = "W12")
-   "!=" = unequal   (7 != 8  is true)
-   "+=" = add right value to left variable,
-             if F = 3, then (F += 4) yields F = 7
-   "-=" = subtract right value from left variable
-
-1. Convert input to Y M D
-   Y = Year     (full specification; input 98 = year 0098)
-		(Y must be larger than -1)
-   M = Month    (1 through 12)
-   D = Day      (1 through 31)
-2. Find if Y is LeapYear
-   if (Y % 4 = 0  and  Y % 100 != 0) or Y % 400 = 0
-      then
-         Y is LeapYear
-      else
-         Y is not LeapYear
-3. Find if Y-1 is LeapYear
-4. Find the DayOfYearNumber for Y M D
-   Mnth[1] = 0    Mnth[4] = 90    Mnth[7] = 181   Mnth[10] = 273
-   Mnth[2] = 31   Mnth[5] = 120   Mnth[8] = 212   Mnth[11] = 304
-   Mnth[3] = 59   Mnth[6] = 151   Mnth[9] = 243   Mnth[12] = 334
-   DayOfYearNumber = D + Mnth[M]
-   if Y is LeapYear and M > 2
-      then
-         DayOfYearNumber += 1
-5. Find the Jan1Weekday for Y (Monday=1, Sunday=7)
-   YY = (Y-1) % 100
-   C = (Y-1) - YY
-   G = YY + YY/4
-   Jan1Weekday = 1 + (((((C / 100) % 4) x 5) + G) % 7)
-6. Find the Weekday for Y M D
-   H = DayOfYearNumber + (Jan1Weekday - 1)
-   Weekday = 1 + ((H -1) % 7)
-7. Find if Y M D falls in YearNumber Y-1, WeekNumber 52 or 53
-   if DayOfYearNumber <= (8-Jan1Weekday) and Jan1Weekday > 4
-      then
-         YearNumber = Y - 1 
-         if Jan1Weekday = 5 or (Jan1Weekday = 6 and Y-1 is LeapYear)
-            then
-               WeekNumber = 53
-            else 
-               WeekNumber = 52
-      else 
-         YearNumber = Y
-8. Find if Y M D falls in YearNumber Y+1, WeekNumber 1
-   if YearNumber = Y
-      then
-         if Y is LeapYear
-            then 
-               I = 366
-               else
-               I = 365
-         if (I - DayOfYearNumber) < (4 - Weekday)
-            then
-               YearNumber = Y + 1
-               WeekNumber = 1
-9. Find if Y M D falls in YearNumber Y, WeekNumber 1 through 53
-   if YearNumber = Y
-      then
-         J = DayOfYearNumber + (7 - Weekday) + (Jan1Weekday -1)
-         WeekNumber = J / 7
-         if Jan1Weekday > 4
-               WeekNumber -= 1
-10. Output ISO Week Date:
-   if WeekNumber < 10
-      then
-         WeekNumber = "0" & WeekNumber  (WeekNumber requires 2 digits)
-   Print: YearNumber & "-" & WeekNumber & "-" & Weekday    (Optional: "-W" & WeekNumber)
-*/
-
-	bool		bLeapYear;										// Is Y a leapyear?
-	bool		bPLeapYear;										// Is Y - 1 a leapyear?
-	uint32_t	DayOfYearNumber;								// The number of the day of the year.
-	uint32_t	Jan1Weekday;									// Which day is Jan 1?
-	uint32_t	Weekday;										// The day of the week (Y, M, D).
-	uint8_t		WeekNumber;										// The calendar week number.
-	uint32_t	YearNumber;										// Y for calculations.
-	long	I;													// How many days a year has.
-
-	// (1) comes in as parameters Y, M, and D.
-
-	// (2):
-	bLeapYear = IsLeapYear (y);
-
-	// (3).
-	bPLeapYear = IsLeapYear (y - 1);
-	
-	// (4).
-	DayOfYearNumber = GetISO8601DayOfYear (y, m, d);
+int64_t DaysFromCivil (uint32_t y, uint8_t m, uint8_t d)
+{	// See https://howardhinnant.github.io/date_algorithms.html#days_from_civil
+	//	(Howard Hinnant). The year starts on March 1st, which moves the leap day to the
+	//	end of the year and removes all branches.
+	ubf_assert (   0 < y);
+	ubf_assert (   0 < m);
+	ubf_assert (  13 > m);
+	ubf_assert (   0 < d);
+	ubf_assert (  32 > d);
 
-	// (5).
-	Jan1Weekday = GetISO8601Jan1WeekDay (y);
+	uint32_t	yy	= y - (m < 3);
+	uint32_t	era	= yy / 400;
+	uint32_t	yoe	= yy - era * 400;							// [0, 399]
+	uint32_t	mp	= (m + 9) % 12;								// [0, 11], 0 == March.
+	uint32_t	doy	= (153 * mp + 2) / 5 + d - 1;				// [0, 365]
+	uint32_t	doe	= yoe * 365 + yoe / 4 - yoe / 100 + doy;	// [0, 146096]
+	return (int64_t) era * 146097 + (int64_t) doe - 719468;
+}
 
-	// (6).
-	Weekday = 1 + ((DayOfYearNumber + (Jan1Weekday - 1) - 1) % 7);
+uint8_t DayOfWeekFromDays (int64_t days)
+{	// 1970-01-01 was a Thursday.
+	return (uint8_t) ((days % 7 + 10) % 7);						// 0 == Monday.
+}
 
-	// Disables the compiler warning that the variable is potentially uninitialised.
-	WeekNumber = 0;
+uint8_t GetISO8601WeekNumberFromDate (uint32_t y, uint8_t m, uint8_t d, uint32_t *aY)
+{
+	/*
+		ISO 8601 week 01 of a year is the week that contains the year's first Thursday.
+		The Thursday of the week the date falls in therefore determines both the year number
+		and the week number. This replaces Rick McCarty's algorithm
+		(http://personal.ecu.edu/mccartyr/ISOwdALG.txt) and gives identical results.
+	*/
+	int64_t		days	= DaysFromCivil (y, m, d);
+	int64_t		thu		= days - DayOfWeekFromDays (days) + 3;
+	uint32_t	YearNumber	= y
+						-	(thu <  DaysFromCivil (y, 1, 1))
+						+	(thu >= DaysFromCivil (y + 1, 1, 1));
 
-	// (7).
-	if (DayOfYearNumber <= (8 - Jan1Weekday) && Jan1Weekday > 4)
-	{
-		YearNumber = y - 1;
-		if (Jan1Weekday == 5 || (Jan1Weekday == 6 && bPLeapYear))
-			WeekNumber = 53;
-		else 
-			WeekNumber = 52;
-	} else 
-		YearNumber = y;
-
-	// (8).
-	if (YearNumber == y)
-	{
-		if (bLeapYear)
-			I = 366;
-		else
-			I = 365;
-		if (((int32_t) I - (int32_t) DayOfYearNumber) < ((int32_t) 4 - (int32_t) Weekday))
-		{
-			YearNumber = y + 1;
-			WeekNumber = 1;
-		}
-	}
 	if (aY)						// Return the corrected (adjusted) year number so that
 		*aY = YearNumber;		//  the caller can use it.
 	// Note that this year number does not need to be identical to the default year
-	//  number. It can be Y - 1.
-
-	// (9).
-	if (YearNumber == y)
-	{
-		uint32_t wn = (DayOfYearNumber + (7 - Weekday) + (Jan1Weekday - 1)) / 7;
-		ubf_assert (wn < UINT8_MAX);
-		ubf_assert (wn < INT8_MAX);
-		WeekNumber = (uint8_t) wn;
-		if (Jan1Weekday > 4)
-			WeekNumber -= 1;
-	}
+	//  number. It can be Y - 1 or Y + 1.
 
-	// (10).
-	//  Not required in C.
-
-	return WeekNumber;
+	int64_t		wn		= (thu - DaysFromCivil (YearNumber, 1, 1)) / 7 + 1;
+	ubf_assert (0 < wn);
+	ubf_assert (54 > wn);
+	return (uint8_t) wn;
 }
 
 bool HasMonth28Days (uint32_t y, uint8_t m)
@@ -1052,8 +936,8 @@ uint8_t _DayOfWeek (uint32_t y, uint8_t m, uint8_t d)
 
 uint8_t DayOfWeek (uint32_t y, uint8_t m, uint8_t d)
 {
-	uint8_t dow = _DayOfWeek (y, m, d);							// 0 == Sunday.
-	return dow ? dow - 1 : 6;									// 0 == Monday, 6 == Sunday.
+	ubf_assert (1752 < y);										// In the U.K.
+	return DayOfWeekFromDays (DaysFromCivil (y, m, d));			// 0 == Monday, 6 == Sunday.
 }
 
 void FILETIME_to_ISO8601 (char *chISO, FILETIME *ft)
@@ -2371,6 +2255,35 @@ bool FormattedMilliseconds (char *chFormatted, const uint64_t uiTimeInMillisecon
 		ubf_assert (b);
 
 		// See https://www.epochconverter.com/weeks/2000 .
+		ub = GetISO8601WeekNumberFromDate (2026, 12, 31, &uYear);
+		ubf_expect_bool_AND (b, 53 == ub);
+		ubf_expect_bool_AND (b, 2026 == uYear);
+		ub = GetISO8601WeekNumberFromDate (2027, 1, 3, &uYear);
+		ubf_expect_bool_AND (b, 53 == ub);
+		ubf_expect_bool_AND (b, 2026 == uYear);
+		ub = GetISO8601WeekNumberFromDate (2024, 12, 30, &uYear);
+		ubf_expect_bool_AND (b, 1 == ub);
+		ubf_expect_bool_AND (b, 2025 == uYear);
+
+		// DaysFromCivil () and DayOfWeekFromDays () against _DayOfWeek (), which returns
+		//	0 for Sunday.
+		ubf_expect_bool_AND (b, 0 == DaysFromCivil (1970, 1, 1));
+		ubf_expect_bool_AND (b, 11017 == DaysFromCivil (2000, 3, 1));
+		int64_t iDays = DaysFromCivil (1800, 1, 1);
+		for (uint32_t y = 1800; y < 2401; ++ y)
+		{
+			for (uint8_t m = 1; m < 13; ++ m)
+			{
+				uint8_t nDays = DaysInMonth (y, m);
+				for (uint8_t d = 1; d <= nDays; ++ d)
+				{
+					ubf_expect_bool_AND (b, iDays == DaysFromCivil (y, m, d));
+					ub = _DayOfWeek (y, m, d);
+					ubf_expect_bool_AND (b, (ub + 6) % 7 == DayOfWeekFromDays (iDays));
+					++ iDays;
+				}
+			}
+		}
 		ub = GetISO8601WeekNumberFromDate (1999, 12, 26, &uYear);
 		ubf_expect_bool_AND (b, 51 == ub);
 		ubf_expect_bool_AND (b, 1999 == uYear);
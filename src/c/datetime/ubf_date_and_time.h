@@ -749,13 +749,31 @@ uint8_t GetISO8601Jan1WeekDay (uint32_t Y);
 */
 uint32_t GetISO8601WeekDay (uint32_t y, uint8_t m, uint8_t d);
 
+/*
+	DaysFromCivil
+	
+	Returns the number of days between 1970-01-01 and the given date of the proleptic
+	Gregorian calendar. Dates before 1970-01-01 return negative values. The function
+	contains no branches and no lookup tables.
+*/
+int64_t DaysFromCivil (uint32_t y, uint8_t m, uint8_t d);
+
+/*
+	DayOfWeekFromDays
+	
+	Returns the day of the week according to ISO 8601 weekday ordering, starting with
+	0 == Monday, 1 == Tuesday, ..., 6 == Sunday, for a day number returned by
+	DaysFromCivil ().
+*/
+uint8_t DayOfWeekFromDays (int64_t days);
+
 /*
 	GetISO8601WeekNumberFromDate
 	
 	Returns the ISO 8601 week number for the given date. The parameter
 	aY points to a uint32_t variable in which the function stores the year
-	number which may have been adjusted to y + 1. The caller is advised
-	to always work with this returned year.
+	number which may have been adjusted to y - 1 or y + 1. The caller is advised
+	to always work with this returned year. The parameter aY can be NULL.
 */
 uint8_t GetISO8601WeekNumberFromDate (uint32_t y, uint8_t m, uint8_t d, uint32_t *aY);
 
@@ -822,8 +840,8 @@ uint8_t _DayOfWeek (uint32_t y, uint8_t m, uint8_t d);
 	Returns the day of the week according to ISO 8601 weekday ordering, starting with
 	0 == Monday, 1 == Tuesday, ..., 6 == Sunday.
 
-	The year must be > 1752, at least in the UK, since the function calls _DayOfWeek ()
-	to obtain the day of week and adjusts it to an ISO 8601 weekday.
+	The year must be > 1752, at least in the UK. The function calls DaysFromCivil () and
+	DayOfWeekFromDays ().
 */
 uint8_t DayOfWeek (uint32_t y, uint8_t m, uint8_t d);
 
@@ -60,6 +60,13 @@ When		Who				What
 		#ifdef PLATFORM_IS_WINDOWS
 			#include "./WinAPI_U8.h"
 		#else
+			#include <fcntl.h>
+			#include <unistd.h>
+			#include <sys/stat.h>
+			#include <sys/file.h>
+			#ifndef EXTCOMPRESSORS_BUILD_WITHOUT_MMAP
+			#include <sys/mman.h>
+			#endif
 		#endif
 
 	#else
@@ -76,6 +83,13 @@ When		Who				What
 		#ifdef PLATFORM_IS_WINDOWS
 			#include "./../OS/Windows/WinAPI_U8.h"
 		#else
+			#include <fcntl.h>
+			#include <unistd.h>
+			#include <sys/stat.h>
+			#include <sys/file.h>
+			#ifndef EXTCOMPRESSORS_BUILD_WITHOUT_MMAP
+			#include <sys/mman.h>
+			#endif
 		#endif
 
 	#endif
@@ -124,7 +138,7 @@ static inline bool openFileForReading (CUNILOG_LOGFILE *pclf, const char *szFile
 		pclf->fd = open (szFileName, O_RDONLY | O_LARGEFILE | O_DIRECT);
 		if (pclf->fd < 0)
 			return false;
-		if (flock(fd, LOCK_EX | LOCK_NB) < 0)
+		if (flock (pclf->fd, LOCK_EX | LOCK_NB) < 0)
 		{
 			close (pclf->fd);
 			pclf->fd = -1;
@@ -158,7 +172,7 @@ static inline bool openFileForOverWriting (CUNILOG_LOGFILE *pclf, const char *sz
 		}
 		return INVALID_HANDLE_VALUE != pclf->hLogFile;
 	#else
-		Pclf->fd = open (szFileName, O_WRONLY | O_CREAT | O_LARGEFILE | O_DIRECT);
+		pclf->fd = open (szFileName, O_WRONLY | O_CREAT | O_LARGEFILE | O_DIRECT);
 		return -1 != pclf->fd;
 	#endif
 }
@@ -419,17 +433,16 @@ static inline bool storeCRCandSize	(
 	uint32_t uiToWrite	= stOutBuf - avail;
 	*puiTotalOut		+= uiToWrite;
 
-	#ifdef PLATFORM_IS_WINDOWS
-		uiBeforePadding = uiToWrite;
-		uiToWrite = ALIGNED_SIZE (uiToWrite, uiPhysSectSize);
+	// Unbuffered I/O on both platforms (FILE_FLAG_NO_BUFFERING/O_DIRECT).
+	uiBeforePadding = uiToWrite;
+	uiToWrite = ALIGNED_SIZE (uiToWrite, uiPhysSectSize);
 
-		// Overwrite the padding.
-		if (uiBeforePadding != uiToWrite)
-			memset (ucOutBuf + uiBeforePadding, 0, uiToWrite - uiBeforePadding);
+	// Overwrite the padding.
+	if (uiBeforePadding != uiToWrite)
+		memset (ucOutBuf + uiBeforePadding, 0, uiToWrite - uiBeforePadding);
 
-		// This obviously requires that we're below the size of the buffer.
-		ubf_assert (uiToWrite <= stOutBuf);
-	#endif
+	// This obviously requires that we're below the size of the buffer.
+	ubf_assert (uiToWrite <= stOutBuf);
 
 	if (!writeToFile (&uiWrittenToOutFile, clout, ucOutBuf, uiToWrite))
 		return false;
@@ -479,6 +492,166 @@ static inline bool storeCRCandSize	(
 	}
 #endif
 
+#if defined (PLATFORM_IS_POSIX) && !defined (EXTCOMPRESSORS_BUILD_WITHOUT_MMAP)
+	#define EXTCOMPRESSORS_USE_MMAP
+#endif
+
+/*
+	The source of the uncompressed data. With a mapping (ucMap not NULL) the deflater
+	reads directly from the mapped file, otherwise from ucInpBuf, which is filled by
+	readFromFile ().
+*/
+typedef struct extcompinput
+{
+	CUNILOG_LOGFILE		clf;
+	unsigned char		*ucInpBuf;
+	uint32_t			uiChunk;							// Max. octets handed over at once.
+	bool				bLast;								// Last chunk handed over.
+	#ifdef EXTCOMPRESSORS_USE_MMAP
+		unsigned char	*ucMap;
+		size_t			stMap;								// Size of the mapping.
+		size_t			stCur;								// Start of the current chunk.
+		size_t			stPos;								// Start of the next chunk.
+	#endif
+} EXTCOMPINPUT;
+
+#ifdef EXTCOMPRESSORS_USE_MMAP
+	static inline bool mapInputFile (EXTCOMPINPUT *pinp)
+	{
+		ubf_assert_non_NULL (pinp);
+
+		struct stat	statbuf;
+
+		pinp->ucMap = NULL;
+		pinp->stMap = 0;
+		pinp->stCur = 0;
+		pinp->stPos = 0;
+
+		// An empty file cannot be mapped. It is read the conventional way.
+		if (0 != fstat (pinp->clf.fd, &statbuf) || statbuf.st_size <= 0)
+			return false;
+		if ((uint64_t) statbuf.st_size > SIZE_MAX)
+			return false;
+
+		size_t	stMap	= (size_t) statbuf.st_size;
+		void	*pm		= mmap (NULL, stMap, PROT_READ, MAP_PRIVATE, pinp->clf.fd, 0);
+		if (MAP_FAILED == pm)
+			return false;
+		madvise (pm, stMap, MADV_SEQUENTIAL);
+		posix_fadvise (pinp->clf.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		pinp->ucMap = pm;
+		pinp->stMap = stMap;
+		return true;
+	}
+#endif
+
+#ifdef EXTCOMPRESSORS_USE_MMAP
+	/*
+		Drops the pages of the chunk the deflater has consumed already from our mapping
+		and from the page cache. The file is not going to be read again, and keeping
+		its pages around would only push more useful data out of the cache.
+	*/
+	static inline void releaseConsumedInput (EXTCOMPINPUT *pinp)
+	{
+		ubf_assert_non_NULL (pinp);
+		ubf_assert (pinp->stCur <= pinp->stPos);
+
+		if (pinp->stCur == pinp->stPos)
+			return;
+
+		size_t	stPage	= (size_t) sysconf (_SC_PAGESIZE);
+		size_t	stFrom	= pinp->stCur - pinp->stCur % stPage;
+		size_t	stTo	= pinp->stPos - pinp->stPos % stPage;
+		if (stTo > stFrom)
+			madvise (pinp->ucMap + stFrom, stTo - stFrom, MADV_DONTNEED);
+		posix_fadvise	(
+			pinp->clf.fd, (off_t) pinp->stCur, (off_t) (pinp->stPos - pinp->stCur),
+			POSIX_FADV_DONTNEED
+						);
+	}
+#endif
+
+static inline bool prepareInput (EXTCOMPINPUT *pinp, uint32_t uiPhysSectSize, uint32_t uiChunk)
+{
+	ubf_assert_non_NULL (pinp);
+
+	pinp->ucInpBuf	= NULL;
+	pinp->uiChunk	= uiChunk;
+	pinp->bLast		= false;
+
+	#ifdef EXTCOMPRESSORS_USE_MMAP
+		if (mapInputFile (pinp))
+			return true;
+	#endif
+	pinp->ucInpBuf = mallocAligned (uiPhysSectSize, uiChunk);
+	return NULL != pinp->ucInpBuf;
+}
+
+static inline void doneInput (EXTCOMPINPUT *pinp)
+{
+	ubf_assert_non_NULL (pinp);
+
+	#ifdef EXTCOMPRESSORS_USE_MMAP
+		if (pinp->ucMap)
+		{
+			// The last chunk is only released here. The file is still open.
+			releaseConsumedInput (pinp);
+			munmap (pinp->ucMap, pinp->stMap);
+			pinp->ucMap = NULL;
+		}
+	#endif
+	if (pinp->ucInpBuf)
+	{
+		freeAligned (pinp->ucInpBuf);
+		pinp->ucInpBuf = NULL;
+	}
+}
+
+/*
+	Hands the next chunk of uncompressed data over to the deflater and updates the CRC32.
+	Returns false if the data could not be read.
+*/
+static inline bool nextInputChunk (EXTCOMPINPUT *pinp, z_stream *pstream, mz_ulong *pulCRC32)
+{
+	ubf_assert_non_NULL (pinp);
+	ubf_assert_non_NULL (pstream);
+	ubf_assert_non_NULL (pulCRC32);
+	ubf_assert_0 (pstream->avail_in);
+
+	#ifdef EXTCOMPRESSORS_USE_MMAP
+		if (pinp->ucMap)
+		{
+			releaseConsumedInput (pinp);
+
+			size_t stChunk = pinp->stMap - pinp->stPos;
+			if (stChunk > pinp->uiChunk)
+				stChunk = pinp->uiChunk;
+
+			pstream->next_in	= pinp->ucMap + pinp->stPos;
+			pstream->avail_in	= (unsigned int) stChunk;
+			*pulCRC32 = mz_crc32 (*pulCRC32, pstream->next_in, stChunk);
+
+			pinp->stCur			= pinp->stPos;
+			pinp->stPos			+= stChunk;
+			pinp->bLast			= pinp->stPos == pinp->stMap;
+			return true;
+		}
+	#endif
+
+	uint32_t	uiReadFromInpFile;
+	if (!readFromFile (&uiReadFromInpFile, pinp->ucInpBuf, pinp->uiChunk, pinp->clf))
+		return false;
+	ubf_assert (uiReadFromInpFile <= pinp->uiChunk);
+	moveFilePointerForward (pinp->clf, uiReadFromInpFile);
+
+	pstream->next_in	= pinp->ucInpBuf;
+	pstream->avail_in	= uiReadFromInpFile;
+	*pulCRC32 = mz_crc32 (*pulCRC32, pinp->ucInpBuf, uiReadFromInpFile);
+
+	pinp->bLast			= uiReadFromInpFile < pinp->uiChunk;
+	return true;
+}
+
 bool extCompressFile	(
 		const char		*szInflatedFile,
 		size_t			lnInflatedFile,
@@ -505,8 +678,8 @@ bool extCompressFile	(
 		char *szZipName = szNames + ALIGNED_SIZE (lnInflatedFile + 1, CUNILOG_DEFAULT_ALIGNMENT);
 		storeFileNames (szNames, szZipName, szInflatedFile, lnInflatedFile);
 
-		CUNILOG_LOGFILE clinp;
-		if (!openFileForReading (&clinp, szOrgName))
+		EXTCOMPINPUT inp;
+		if (!openFileForReading (&inp.clf, szOrgName))
 			goto cant_open_input_file;
 
 		uint32_t uiPhysSectSize;
@@ -516,11 +689,11 @@ bool extCompressFile	(
 		{
 			bool b;
 			#ifdef PLATFORM_IS_WINDOWS
-				b = GetPhysicalSectorSizeFromHandle (clinp.hLogFile, (DWORD *) &uiPhysSectSize);
+				b = GetPhysicalSectorSizeFromHandle (inp.clf.hLogFile, (DWORD *) &uiPhysSectSize);
 				UNUSED_PARAMETER (b);
 			#else
 				blksize_t st_blksize;
-				b = GetPhysicalSectorSizeFromFD (clinp.fd, &st_blksize);
+				b = GetPhysicalSectorSizeFromFD (inp.clf, &st_blksize);
 				uiPhysSectSize = (uint32_t) st_blksize;
 			#endif
 
@@ -534,20 +707,20 @@ bool extCompressFile	(
 		if (!openFileForOverWriting (&clout, szZipName))
 			goto cant_open_output_file;
 
-		// Our buffers.
+		// Our buffers. The input buffer is not required if the input file is mapped.
 		uint32_t uiReadWrite = EXTCOMPRESSORS_DEF_SECT_FACTOR * uiPhysSectSize;
-		unsigned char *ucInpBuf = mallocAligned (uiPhysSectSize, uiReadWrite);
-		if (NULL == ucInpBuf)
+		if (!prepareInput (&inp, uiPhysSectSize, uiReadWrite))
 			goto cant_malloc_input_buf;
 		unsigned char *ucOutBuf = mallocAligned (uiPhysSectSize, uiReadWrite);
 		if (NULL == ucOutBuf)
 			goto cant_malloc_output_buf;
 		memcpy (ucOutBuf, ccGzipHeader, sizeof (ccGzipHeader));
 
-		uint64_t	uiTotalOut	= sizeof (ccGzipHeader);
+		// The header is in ucOutBuf and is counted when the buffer is written out.
+		uint64_t	uiTotalOut	= 0;
 		z_stream	stream;
 		memset (&stream, 0, sizeof (stream));
-		stream.next_in			= ucInpBuf;
+		stream.next_in			= NULL;
 		stream.avail_in			= 0;
 		stream.next_out			= ucOutBuf		+ sizeof (ccGzipHeader);
 		stream.avail_out		= uiReadWrite	- sizeof (ccGzipHeader);
@@ -562,32 +735,24 @@ bool extCompressFile	(
 		if (Z_OK != deflateInit2 (&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY))
 			goto cant_deflate_init;
 
-		uint32_t	uiReadFromInpFile	= 0;
 		uint32_t	uiWrittenToOutFile;
 		int			currsts				= Z_OK;
 		mz_ulong	ulCRC32				= 0;
 
 		while (true)
 		{
-			if (0 == stream.avail_in)
+			if (0 == stream.avail_in && !inp.bLast)
 			{
-				if (readFromFile (&uiReadFromInpFile, ucInpBuf, uiReadWrite, clinp))
+				if (!nextInputChunk (&inp, &stream, &ulCRC32))
 				{
-					ubf_assert (uiReadFromInpFile <= uiReadWrite);
-					moveFilePointerForward (clinp, uiReadFromInpFile);
-
-					stream.next_in		= ucInpBuf;
-					stream.avail_in		= uiReadFromInpFile;
-
-					ulCRC32 = mz_crc32 (ulCRC32, ucInpBuf, uiReadFromInpFile);
+					deflateEnd (&stream);
+					break;
 				}
 			}
 
-			mz_ulong muprev = stream.avail_out;
 			ubf_assert_non_0 (stream.avail_out);
-			currsts = deflate (&stream, uiReadFromInpFile == uiReadWrite ? Z_NO_FLUSH : Z_FINISH);
+			currsts = deflate (&stream, inp.bLast ? Z_FINISH : Z_NO_FLUSH);
 			ubf_assert (Z_OK == currsts || Z_STREAM_END == currsts);
-			uiTotalOut += muprev - stream.avail_out;
 
 			if (0 == stream.avail_out)
 			{
@@ -618,13 +783,13 @@ bool extCompressFile	(
 
 	cant_malloc_output_buf:
 		closeFile (clout);
-		freeAligned (ucInpBuf);
+		doneInput (&inp);
 
 	cant_malloc_input_buf:
 	cant_open_output_file:
 		if (bRet && encompress_delete_source_file == compressOrDelete)
 			deleteFile (szOrgName);
-		closeFile (clinp);
+		closeFile (inp.clf);
 
 	cant_open_input_file:
 		free (szNames);
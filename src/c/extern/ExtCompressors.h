@@ -57,6 +57,8 @@ When		Who				What
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifndef CUNILOG_USE_COMBINED_MODULE
 
@@ -84,6 +86,18 @@ When		Who				What
 #define EXTCOMPRESSORS_DEF_SECT_SIZE		(512)
 #endif
 
+/*
+	On POSIX, extCompressFile () maps the uncompressed file into memory and hands the
+	mapping directly to the deflater instead of copying it chunk by chunk into an input
+	buffer first. Pages that have been consumed are released from the page cache again.
+	Define EXTCOMPRESSORS_BUILD_WITHOUT_MMAP to read the file into a buffer of
+	EXTCOMPRESSORS_DEF_SECT_FACTOR times the physical sector size instead, which is what
+	the Windows version always does.
+*/
+#ifndef EXTCOMPRESSORS_BUILD_WITHOUT_MMAP
+//#define EXTCOMPRESSORS_BUILD_WITHOUT_MMAP
+#endif
+
 /*
 	Memory alignments. Use 16 octets/bytes for 64 bit platforms.
 	Use CUNILOG_DEFAULT_ALIGNMENT for structures and CUNILOG_POINTER_ALIGNMENT
@@ -0,0 +1,207 @@
+/****************************************************************************************
+
+	File:		strjson.c
+	Why:		JSON string functions.
+	OS:			C99.
+	Author:		Thomas
+	Created:	2026-10-19
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-19	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024-2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <stdint.h>
+
+#ifndef CUNILOG_USE_COMBINED_MODULE
+
+	#include "./strjson.h"
+
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./ubfdebug.h"
+	#else
+		#include "./../dbg/ubfdebug.h"
+	#endif
+
+#endif
+
+#ifdef STRJSON_USE_SSE2
+	#include <emmintrin.h>
+	#if defined (_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+static const char ccHexJSON [] = "0123456789ABCDEF";
+
+/*
+	Writes the escape sequence for c to szOut and returns its length.
+*/
+static inline size_t strJSONescapeChar (char *szOut, unsigned char c)
+{
+	switch (c)
+	{
+		case '"':	szOut [0] = '\\';	szOut [1] = '"';	return 2;
+		case '\\':	szOut [0] = '\\';	szOut [1] = '\\';	return 2;
+		case '\b':	szOut [0] = '\\';	szOut [1] = 'b';	return 2;
+		case '\f':	szOut [0] = '\\';	szOut [1] = 'f';	return 2;
+		case '\n':	szOut [0] = '\\';	szOut [1] = 'n';	return 2;
+		case '\r':	szOut [0] = '\\';	szOut [1] = 'r';	return 2;
+		case '\t':	szOut [0] = '\\';	szOut [1] = 't';	return 2;
+		default:
+			ubf_assert (c < 0x20);
+			memcpy (szOut, "\\u00", 4);
+			szOut [4] = ccHexJSON [c >> 4];
+			szOut [5] = ccHexJSON [c & 0x0F];
+			return 6;
+	}
+}
+
+static inline bool strJSONrequiresEscape (unsigned char c)
+{
+	return c < 0x20 || '"' == c || '\\' == c;
+}
+
+#ifdef STRJSON_USE_SSE2
+	static inline unsigned int strJSONfirstBit (unsigned int ui)
+	{
+		ubf_assert (ui);
+
+		#if defined (_MSC_VER)
+			unsigned long idx;
+			_BitScanForward (&idx, ui);
+			return (unsigned int) idx;
+		#elif defined(__clang__) || defined(__GNUC__)
+			return (unsigned int) __builtin_ctz (ui);
+		#else
+			#error Not supported
+		#endif
+	}
+#endif
+
+size_t strJSONescape (char *szOut, const char *sz, size_t len)
+{
+	ubf_assert_non_NULL	(szOut);
+	ubf_assert			(sz || 0 == len);
+
+	char	*szOrg	= szOut;
+	size_t	i		= 0;
+
+	#ifdef STRJSON_USE_SSE2
+		const __m128i	vQuote		= _mm_set1_epi8 ('"');
+		const __m128i	vBackslash	= _mm_set1_epi8 ('\\');
+		const __m128i	vCtrlMax	= _mm_set1_epi8 (0x1F);
+
+		while (i + 16 <= len)
+		{
+			__m128i	v	= _mm_loadu_si128 ((const __m128i *) (sz + i));
+			// Unsigned v <= 0x1F is the same as max (v, 0x1F) == 0x1F.
+			__m128i	m	= _mm_or_si128	(
+								_mm_or_si128	(
+									_mm_cmpeq_epi8 (v, vQuote),
+									_mm_cmpeq_epi8 (v, vBackslash)
+												),
+								_mm_cmpeq_epi8 (_mm_max_epu8 (v, vCtrlMax), vCtrlMax)
+									);
+			unsigned int uiMask = (unsigned int) _mm_movemask_epi8 (m);
+			if (0 == uiMask)
+			{
+				_mm_storeu_si128 ((__m128i *) szOut, v);
+				szOut	+= 16;
+				i		+= 16;
+				continue;
+			}
+			// Copy up to the first character that needs escaping.
+			unsigned int uiFirst = strJSONfirstBit (uiMask);
+			memcpy (szOut, sz + i, uiFirst);
+			szOut	+= uiFirst;
+			i		+= uiFirst;
+			szOut	+= strJSONescapeChar (szOut, (unsigned char) sz [i]);
+			++ i;
+		}
+	#endif
+
+	size_t	r		= i;									// Start of the current run.
+	while (i < len)
+	{
+		if (strJSONrequiresEscape ((unsigned char) sz [i]))
+		{
+			memcpy (szOut, sz + r, i - r);
+			szOut	+= i - r;
+			szOut	+= strJSONescapeChar (szOut, (unsigned char) sz [i]);
+			r		= i + 1;
+		}
+		++ i;
+	}
+	memcpy (szOut, sz + r, i - r);
+	szOut += i - r;
+	return (size_t) (szOut - szOrg);
+}
+
+#ifdef STRJSON_BUILD_TEST
+	bool test_strjson (void)
+	{
+		bool	b	= true;
+		char	sz [STRJSON_MAX_ESCAPED_LEN (64)];
+		size_t	ln;
+
+		ln = strJSONescape (sz, "", 0);
+		b &= 0 == ln;
+		ubf_assert_true (b);
+
+		ln = strJSONescape (sz, "abc", 3);
+		b &= 3 == ln && !memcmp (sz, "abc", 3);
+		ubf_assert_true (b);
+
+		ln = strJSONescape (sz, "a\"b\\c\n", 6);
+		b &= 9 == ln && !memcmp (sz, "a\\\"b\\\\c\\n", 9);
+		ubf_assert_true (b);
+
+		// Longer than 16 octets to exercise the vectorised path, with an escape in the
+		//	second block and a UTF-8 sequence that must not be treated as control characters.
+		const char *szIn	= "0123456789ABCDEF\xC3\xA4" "0123456789\x01" "ABCDEFGHIJKLMNOPQRSTUV\"";
+		const char *szExp	= "0123456789ABCDEF\xC3\xA4" "0123456789\\u0001" "ABCDEFGHIJKLMNOPQRSTUV\\\"";
+		ln = strJSONescape (sz, szIn, strlen (szIn));
+		b &= strlen (szExp) == ln && !memcmp (sz, szExp, ln);
+		ubf_assert_true (b);
+
+		// Escapes within the first 16 octets only.
+		ln = strJSONescape (sz, "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t", 17);
+		b &= 34 == ln && !memcmp (sz, "\\t\\t\\t", 6) && !memcmp (sz + 32, "\\t", 2);
+		ubf_assert_true (b);
+
+		return b;
+	}
+#endif
@@ -0,0 +1,117 @@
+/****************************************************************************************
+
+	File:		strjson.h
+	Why:		JSON string functions.
+	OS:			C99.
+	Author:		Thomas
+	Created:	2026-10-19
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2026-10-19	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024-2026 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STRJSON_H
+#define STRJSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef CUNILOG_USE_COMBINED_MODULE
+
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./externC.h"
+		#include "./platform.h"
+	#else
+		#include "./../pre/externC.h"
+		#include "./../pre/platform.h"
+	#endif
+
+#endif
+
+/*
+	The escaping functions scan 16 octets at a time with SSE2 instructions if the target
+	supports them. Define STRJSON_NO_SSE2 to use the portable version only.
+*/
+#ifndef STRJSON_NO_SSE2
+	#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+		#ifndef STRJSON_USE_SSE2
+		#define STRJSON_USE_SSE2
+		#endif
+	#endif
+#endif
+
+EXTERN_C_BEGIN
+
+/*
+	STRJSON_MAX_ESCAPED_LEN
+
+	The maximum length of the escaped version of a string of len octets. Each control
+	character can require 6 octets ("\u001F").
+*/
+#define STRJSON_MAX_ESCAPED_LEN(len)	((len) * 6)
+
+/*
+	strJSONescape
+
+	Writes the string sz with length len to szOut, with all characters escaped that must
+	be escaped within a JSON string (RFC 8259). These are the quotation mark, the reverse
+	solidus, and the control characters below 0x20. The function does not write the
+	enclosing quotation marks and does not NUL-terminate szOut. UTF-8 sequences are copied
+	unchanged.
+
+	The buffer szOut points to must be at least STRJSON_MAX_ESCAPED_LEN (len) octets long.
+
+	The function returns the amount of octets written to szOut.
+*/
+size_t strJSONescape (char *szOut, const char *sz, size_t len);
+
+#ifdef DEBUG
+	#ifndef STRJSON_BUILD_TEST
+	#define STRJSON_BUILD_TEST
+	#endif
+#endif
+
+/*
+	Test function.
+*/
+#ifdef STRJSON_BUILD_TEST
+	bool test_strjson (void);
+#else
+	#define test_strjson()	(true)
+#endif
+
+EXTERN_C_END
+
+#endif														// Of #ifndef STRJSON_H.
@@ -62,6 +62,7 @@ When		Who				What
 		#include "./strlineextract.h"
 		#include "./strmembuf.h"
 		#include "./strwildcards.h"
+		#include "./strjson.h"
 		#include "./check_utf8.h"
 		#include "./ExeFileName.h"
 		#include "./ProcessHelpers.h"
@@ -94,6 +95,7 @@ When		Who				What
 		#include "./../string/strlineextract.h"
 		#include "./../string/strmembuf.h"
 		#include "./../string/strwildcards.h"
+		#include "./../string/strjson.h"
 		#include "./../string/check_utf8.h"
 		#include "./../OS/ExeFileName.h"
 		#include "./../OS/ProcessHelpers.h"
@@ -550,6 +552,13 @@ bool CunilogTestFunction	(
 		CunilogTestFnctDisabledToConsole (test_strnewline ());
 	#endif
 
+	CunilogTestFnctStartTestToConsole ("Internal test of module strjson...");
+	#ifdef STRJSON_BUILD_TEST
+		CunilogTestFnctResultToConsole (test_strjson ());
+	#else
+		CunilogTestFnctDisabledToConsole (test_strjson ());
+	#endif
+
 	CunilogTestFnctStartTestToConsole ("Internal test of module bulkmalloc...");
 	#ifdef BUILD_BULKMALLOC_TEST_FUNCTIONS
 		CunilogTestFnctResultToConsole (bulkmalloc_test_fnct ());